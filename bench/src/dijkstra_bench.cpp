@@ -0,0 +1,65 @@
+/*
+ * Regression benchmark for point-to-point queries on generated grid graphs.
+ *
+ * Each row doubles the side length of a square grid, i.e. quadruples the
+ * number of nodes. A heap-based Dijkstra should show query times growing
+ * roughly like n log n; the normalized column should thus stay near-constant.
+ */
+#include <graphd/graph.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+
+using namespace graphd;
+
+static std::string node_name(int row, int col) {
+    return std::to_string(row) + "_" + std::to_string(col);
+}
+
+static Graph grid(int side, std::mt19937 &rng) {
+    std::uniform_real_distribution<double> weight{1.0, 10.0};
+    Graph g;
+    for (int r = 0; r < side; r++) {
+        for (int c = 0; c < side; c++) {
+            if (r + 1 < side) {
+                g.add_edge(node_name(r, c), node_name(r + 1, c), weight(rng));
+            }
+            if (c + 1 < side) {
+                g.add_edge(node_name(r, c), node_name(r, c + 1), weight(rng));
+            }
+        }
+    }
+    g.freeze();
+    return g;
+}
+
+int main() {
+    std::mt19937 rng{42};
+    std::printf("%8s %10s %12s %16s\n", "side", "nodes", "query [ms]",
+                "ns / (n log n)");
+
+    for (int side = 32; side <= 512; side *= 2) {
+        Graph g = grid(side, rng);
+        NodeName from = node_name(0, 0);
+        NodeName to = node_name(side - 1, side - 1);
+
+        auto start = std::chrono::steady_clock::now();
+        Path p = g.shortest_path(from, to);
+        auto end = std::chrono::steady_clock::now();
+
+        double n = double(side) * side;
+        double ns =
+            std::chrono::duration<double, std::nano>(end - start).count();
+        std::printf("%8d %10.0f %12.3f %16.3f\n", side, n, ns / 1e6,
+                    ns / (n * std::log2(n)));
+
+        if (p.nodes.front() != from || p.nodes.back() != to) {
+            std::fprintf(stderr, "unexpected path endpoints\n");
+            return 1;
+        }
+    }
+    return 0;
+}
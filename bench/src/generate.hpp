@@ -0,0 +1,326 @@
+/*
+ * Deterministic generators for benchmark graphs.
+ *
+ * Every generator takes a seed and produces the same graph for it with any
+ * standard library: random numbers come straight from std::mt19937_64,
+ * whose output is fully specified, rather than from the standard
+ * distributions, whose output is not.
+ *
+ * Nodes are named n0, n1, ... and all graphs come with positions in the
+ * plane. Edge weights are never shorter than the distance between their
+ * endpoints, so A* with the euclidean heuristic applies to all of them,
+ * although it only helps where positions mean something. Positions and
+ * weights are rounded to three decimals, so that a graph parsed from the DOT
+ * output is the same as one built directly.
+ */
+#ifndef _GRAPHD_BENCH_GENERATE_H_
+#define _GRAPHD_BENCH_GENERATE_H_
+
+#include <graphd/graph.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+struct Edge {
+    std::uint32_t from;
+    std::uint32_t to;
+    double weight;
+};
+
+struct Generated {
+    std::vector<graphd::Position> positions;
+    std::vector<Edge> edges;
+
+    std::size_t node_count() const {
+        return positions.size();
+    }
+};
+
+class Random {
+  public:
+    explicit Random(std::uint64_t seed) : engine{seed} {}
+    /**
+     * Uniform in [0, 1).
+     */
+    double unit() {
+        return (engine() >> 11) * 0x1.0p-53;
+    }
+    double uniform(double low, double high) {
+        return low + unit() * (high - low);
+    }
+    /**
+     * Uniform in [0, n).
+     */
+    std::uint32_t below(std::uint32_t n) {
+        return static_cast<std::uint32_t>(unit() * n);
+    }
+
+  private:
+    std::mt19937_64 engine;
+};
+
+inline std::string node_name(std::uint32_t n) {
+    return "n" + std::to_string(n);
+}
+
+inline double distance(const graphd::Position &a, const graphd::Position &b) {
+    return std::hypot(a.x - b.x, a.y - b.y);
+}
+
+inline double round_down(double v) {
+    return std::floor(v * 1000) / 1000;
+}
+
+inline double round_up(double v) {
+    return std::ceil(v * 1000) / 1000;
+}
+
+inline void place(Generated &g, double x, double y) {
+    g.positions.push_back({round_down(x), round_down(y)});
+}
+
+/**
+ * Place a node at a random position, x drawn before y.
+ */
+inline void place_randomly(Generated &g, double x_low, double x_high,
+                           double y_low, double y_high, Random &rng) {
+    double x = rng.uniform(x_low, x_high);
+    double y = rng.uniform(y_low, y_high);
+    place(g, x, y);
+}
+
+/**
+ * Add an edge of at least the distance between its endpoints, up to stretch
+ * times that. Edges shorter than 1 are given length 1.
+ */
+inline void connect(Generated &g, std::uint32_t from, std::uint32_t to,
+                    double stretch, Random &rng) {
+    double d = distance(g.positions[from], g.positions[to]);
+    g.edges.push_back(
+        {from, to, round_up(std::max(d, 1.0) * rng.uniform(1, stretch))});
+}
+
+/**
+ * A square grid of about n nodes at unit spacing, each connected to its four
+ * neighbors.
+ */
+inline Generated grid(std::uint32_t n, std::uint64_t seed) {
+    Random rng{seed};
+    auto side = static_cast<std::uint32_t>(std::max(1.0, std::sqrt(n)));
+    Generated g;
+    for (std::uint32_t r = 0; r < side; r++) {
+        for (std::uint32_t c = 0; c < side; c++) {
+            place(g, c, r);
+        }
+    }
+    for (std::uint32_t r = 0; r < side; r++) {
+        for (std::uint32_t c = 0; c < side; c++) {
+            std::uint32_t node = r * side + c;
+            if (c + 1 < side) {
+                connect(g, node, node + 1, 10, rng);
+            }
+            if (r + 1 < side) {
+                connect(g, node, node + side, 10, rng);
+            }
+        }
+    }
+    return g;
+}
+
+/**
+ * n points spread uniformly over a square, each connected to all points
+ * within a radius chosen for an average degree of about degree.
+ */
+inline Generated geometric(std::uint32_t n, double degree,
+                           std::uint64_t seed) {
+    Random rng{seed};
+    double side = std::sqrt(double(n));
+    // The expected number of points in a circle of radius r is pi r^2.
+    double radius = std::sqrt(degree / std::acos(-1.0));
+    auto cells = static_cast<std::uint32_t>(std::max(1.0, side / radius));
+    double cell_size = side / cells;
+
+    Generated g;
+    std::vector<std::vector<std::uint32_t>> grid(std::size_t(cells) * cells);
+    auto cell_of = [&](double v) {
+        return std::min(cells - 1, static_cast<std::uint32_t>(v / cell_size));
+    };
+    for (std::uint32_t i = 0; i < n; i++) {
+        place_randomly(g, 0, side, 0, side, rng);
+        const graphd::Position &p = g.positions.back();
+        grid[std::size_t(cell_of(p.y)) * cells + cell_of(p.x)].push_back(i);
+    }
+
+    for (std::uint32_t i = 0; i < n; i++) {
+        std::uint32_t cx = cell_of(g.positions[i].x);
+        std::uint32_t cy = cell_of(g.positions[i].y);
+        for (std::uint32_t y = cy > 0 ? cy - 1 : 0;
+             y <= std::min(cells - 1, cy + 1); y++) {
+            for (std::uint32_t x = cx > 0 ? cx - 1 : 0;
+                 x <= std::min(cells - 1, cx + 1); x++) {
+                for (std::uint32_t j : grid[std::size_t(y) * cells + x]) {
+                    if (j > i && distance(g.positions[i], g.positions[j]) <=
+                                     radius) {
+                        connect(g, i, j, 1.2, rng);
+                    }
+                }
+            }
+        }
+    }
+    return g;
+}
+
+/**
+ * An Erdős–Rényi graph: n nodes and n * degree / 2 edges between uniformly
+ * chosen pairs. Positions are random and only serve as a lower bound.
+ */
+inline Generated erdos_renyi(std::uint32_t n, double degree,
+                             std::uint64_t seed) {
+    Random rng{seed};
+    Generated g;
+    for (std::uint32_t i = 0; i < n; i++) {
+        place_randomly(g, 0, 1, 0, 1, rng);
+    }
+    auto m = static_cast<std::size_t>(n * degree / 2);
+    while (g.edges.size() < m && n > 1) {
+        std::uint32_t from = rng.below(n);
+        std::uint32_t to = rng.below(n);
+        if (from != to) {
+            connect(g, from, to, 10, rng);
+        }
+    }
+    return g;
+}
+
+/**
+ * A Barabási–Albert graph: nodes arrive one by one and connect to up to
+ * links distinct earlier nodes, picked with probability proportional to
+ * their degree. Degrees follow a power law, a few hubs have most edges.
+ */
+inline Generated barabasi_albert(std::uint32_t n, std::uint32_t links,
+                                 std::uint64_t seed) {
+    Random rng{seed};
+    Generated g;
+    // Every node once per edge end, to pick from in proportion to degree
+    std::vector<std::uint32_t> ends;
+    std::vector<std::uint32_t> picked;
+    for (std::uint32_t i = 0; i < n; i++) {
+        place_randomly(g, 0, 1, 0, 1, rng);
+        // All earlier nodes have edges by now, except for the first one
+        // while it is the only one, so there are enough to pick from.
+        picked.clear();
+        while (picked.size() < std::min(i, links)) {
+            std::uint32_t to = ends.empty() ? rng.below(i)
+                                            : ends[rng.below(ends.size())];
+            if (to != i && std::find(picked.begin(), picked.end(), to) ==
+                               picked.end()) {
+                picked.push_back(to);
+            }
+        }
+        // The new node's edges only count towards later nodes' picks.
+        for (std::uint32_t to : picked) {
+            connect(g, i, to, 10, rng);
+            ends.push_back(i);
+            ends.push_back(to);
+        }
+    }
+    return g;
+}
+
+/**
+ * Something like a road network: about n junctions on a jittered grid, most
+ * connected to their neighbors by winding local roads, and every eighth row
+ * and column a straight, fast highway.
+ */
+inline Generated road(std::uint32_t n, std::uint64_t seed) {
+    Random rng{seed};
+    auto side = static_cast<std::uint32_t>(std::max(1.0, std::sqrt(n)));
+    Generated g;
+    for (std::uint32_t r = 0; r < side; r++) {
+        for (std::uint32_t c = 0; c < side; c++) {
+            place_randomly(g, c - 0.3, c + 0.3, r - 0.3, r + 0.3, rng);
+        }
+    }
+    for (std::uint32_t r = 0; r < side; r++) {
+        for (std::uint32_t c = 0; c < side; c++) {
+            std::uint32_t node = r * side + c;
+            bool highway_row = r % 8 == 0;
+            bool highway_column = c % 8 == 0;
+            if (c + 1 < side && (highway_row || rng.unit() < 0.85)) {
+                connect(g, node, node + 1, highway_row ? 1.05 : 1.8, rng);
+            }
+            if (r + 1 < side && (highway_column || rng.unit() < 0.85)) {
+                connect(g, node, node + side, highway_column ? 1.05 : 1.8,
+                        rng);
+            }
+        }
+    }
+    return g;
+}
+
+/**
+ * The graph by the name used on the command line, with default parameters.
+ */
+inline Generated generate(const std::string &kind, std::uint32_t n,
+                          std::uint64_t seed) {
+    if (kind == "grid") {
+        return grid(n, seed);
+    } else if (kind == "geometric") {
+        return geometric(n, 8, seed);
+    } else if (kind == "erdos-renyi") {
+        return erdos_renyi(n, 6, seed);
+    } else if (kind == "barabasi-albert") {
+        return barabasi_albert(n, 3, seed);
+    } else if (kind == "road") {
+        return road(n, seed);
+    }
+    throw std::runtime_error{"unknown kind of graph: " + kind};
+}
+
+/**
+ * The graph as a DOT document, positions included.
+ */
+inline std::string to_dot(const Generated &g) {
+    std::string out = "strict graph generated {\n";
+    char buffer[128];
+    for (std::size_t i = 0; i < g.node_count(); i++) {
+        std::snprintf(buffer, sizeof(buffer), "    n%zu [pos=\"%.3f,%.3f\"];\n",
+                      i, g.positions[i].x, g.positions[i].y);
+        out += buffer;
+    }
+    for (const Edge &e : g.edges) {
+        std::snprintf(buffer, sizeof(buffer), "    n%u -- n%u [weight=%.3f];\n",
+                      e.from, e.to, e.weight);
+        out += buffer;
+    }
+    out += "}\n";
+    return out;
+}
+
+/**
+ * The frozen graph, built edge by edge.
+ */
+inline graphd::Graph build(const Generated &g) {
+    graphd::Graph graph;
+    for (std::size_t i = 0; i < g.node_count(); i++) {
+        graph.add_node(node_name(i));
+        graph.set_position(node_name(i), g.positions[i]);
+    }
+    for (const Edge &e : g.edges) {
+        graph.add_edge(node_name(e.from), node_name(e.to), e.weight);
+    }
+    graph.freeze();
+    return graph;
+}
+
+} // namespace bench
+
+#endif // _GRAPHD_BENCH_GENERATE_H_
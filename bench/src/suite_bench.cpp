@@ -0,0 +1,232 @@
+/*
+ * Loading and query performance across kinds of generated graphs.
+ *
+ * For each kind of graph, the generated DOT document is tokenized and
+ * parsed, the graph is built directly from the generated edges, and random
+ * point-to-point queries are answered with each algorithm. Loading stages
+ * report throughput, queries report throughput and latency percentiles.
+ * Full single-source searches are timed both with Dijkstra's algorithm and
+ * with delta-stepping on all hardware threads.
+ * All algorithms must agree on the distances. Contraction hierarchies are
+ * only built for the kinds with locality, on the others nearly every node
+ * ends up connected to every other by shortcuts.
+ *
+ * usage: suite_bench [nodes [queries [kind...]]]
+ * with kinds out of grid, geometric, erdos-renyi, barabasi-albert and road,
+ * all of them by default.
+ */
+#include "generate.hpp"
+
+#include <graphd/ch.hpp>
+#include <graphd/heuristic.hpp>
+#include <graphd/input/parse.hpp>
+#include <graphd/input/token.hpp>
+#include <graphd/pool.hpp>
+#include <graphd/workspace.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace graphd;
+using Clock = std::chrono::steady_clock;
+
+static double ms_since(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start)
+        .count();
+}
+
+static void report_stage(const char *stage, double ms, double mib,
+                         double items) {
+    std::printf("  %-14s %12.1f %10.1f %14.0f\n", stage, ms, mib / (ms / 1e3),
+                items / (ms / 1e3));
+}
+
+/**
+ * The value below which a fraction p of the sorted values fall.
+ */
+static double percentile(const std::vector<double> &sorted, double p) {
+    std::size_t rank = std::ceil(p * sorted.size());
+    return sorted[std::max<std::size_t>(rank, 1) - 1];
+}
+
+struct Query {
+    NodeName from;
+    NodeName to;
+};
+
+using Answer = std::function<Path(const Query &)>;
+
+/**
+ * Answer all queries, report latencies and return the distances found,
+ * infinity where there is no path.
+ */
+static std::vector<double> run_queries(const char *name,
+                                       const std::vector<Query> &queries,
+                                       const Answer &answer) {
+    std::vector<double> distances;
+    std::vector<double> latencies;
+    auto start = Clock::now();
+    for (const Query &q : queries) {
+        auto query_start = Clock::now();
+        try {
+            distances.push_back(answer(q).total_distance);
+        } catch (const std::runtime_error &) {
+            distances.push_back(infinity);
+        }
+        latencies.push_back(ms_since(query_start) * 1e3);
+    }
+    double ms = ms_since(start);
+    if (queries.empty()) {
+        return distances;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    std::printf("  %-14s %12.0f %10.1f %10.1f %10.1f %10.1f\n", name,
+                queries.size() / (ms / 1e3), percentile(latencies, 0.5),
+                percentile(latencies, 0.9), percentile(latencies, 0.99),
+                latencies.back());
+    return distances;
+}
+
+static bool same_distances(const std::vector<double> &a,
+                           const std::vector<double> &b) {
+    for (std::size_t i = 0; i < a.size(); i++) {
+        if (a[i] != b[i] && std::abs(a[i] - b[i]) > 1e-9 * a[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool run_kind(const std::string &kind, std::uint32_t nodes,
+                     std::size_t query_count) {
+    bench::Generated generated = bench::generate(kind, nodes, 42);
+    std::string doc = bench::to_dot(generated);
+    double mib = doc.size() / (1024.0 * 1024.0);
+    std::printf("%s: %zu nodes, %zu edges, %.1f MiB of DOT\n", kind.c_str(),
+                generated.node_count(), generated.edges.size(), mib);
+    std::printf("  %-14s %12s %10s %14s\n", "stage", "time [ms]", "MiB / s",
+                "items / s");
+
+    auto start = Clock::now();
+    input::Tokenizer tok{doc};
+    std::size_t tokens = 0;
+    while (tok.next_token().type != input::TokenType::EOI) {
+        tokens++;
+    }
+    report_stage("tokenize", ms_since(start), mib, tokens);
+
+    start = Clock::now();
+    Graph parsed;
+    input::Parser::of(std::string_view{doc}).parse_into(parsed);
+    parsed.freeze();
+    report_stage("parse", ms_since(start), mib, generated.edges.size());
+
+    start = Clock::now();
+    Graph g = bench::build(generated);
+    report_stage("build", ms_since(start), mib, generated.edges.size());
+
+    std::unique_ptr<ContractionHierarchy> ch;
+    if (kind != "erdos-renyi" && kind != "barabasi-albert") {
+        start = Clock::now();
+        ch = std::make_unique<ContractionHierarchy>(g);
+        report_stage("ch preprocess", ms_since(start), mib, g.node_count());
+    }
+
+    if (parsed.node_count() != g.node_count() ||
+        parsed.edge_count() != g.edge_count()) {
+        std::fprintf(stderr, "parsed graph differs from built graph\n");
+        return false;
+    }
+
+    bench::Random rng{7};
+    std::vector<Query> queries;
+    for (std::size_t i = 0; i < query_count; i++) {
+        std::uint32_t from = rng.below(g.node_count());
+        std::uint32_t to = rng.below(g.node_count());
+        queries.push_back({bench::node_name(from), bench::node_name(to)});
+    }
+
+    std::printf("  %-14s %12s %10s %10s %10s %10s\n", "query", "queries / s",
+                "p50 [us]", "p90 [us]", "p99 [us]", "max [us]");
+    SearchWorkspace ws;
+    auto euclidean = make_heuristic("euclidean", g);
+    std::vector<std::vector<double>> results;
+    results.push_back(run_queries("dijkstra", queries, [&](const Query &q) {
+        return g.shortest_path(q.from, q.to, ws);
+    }));
+    results.push_back(
+        run_queries("bidirectional", queries, [&](const Query &q) {
+            return g.shortest_path(q.from, q.to, ws, Algorithm::BIDIRECTIONAL);
+        }));
+    results.push_back(run_queries("astar", queries, [&](const Query &q) {
+        return g.shortest_path(q.from, q.to, ws, *euclidean);
+    }));
+    if (ch) {
+        results.push_back(run_queries("ch", queries, [&](const Query &q) {
+            return ch->shortest_path(q.from, q.to, ws);
+        }));
+    }
+
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("  %-14s %12s %10s\n", "single source", "time [ms]",
+                "nodes / s");
+    start = Clock::now();
+    ShortestPathTree tree = g.shortest_path_tree(0, ws);
+    double ms = ms_since(start);
+    std::printf("  %-14s %12.1f %10.0f\n", "dijkstra", ms,
+                g.node_count() / (ms / 1e3));
+    ThreadPool pool{threads};
+    start = Clock::now();
+    ShortestPathTree stepped = g.shortest_path_tree(0, pool);
+    ms = ms_since(start);
+    std::string name = "delta x" + std::to_string(threads);
+    std::printf("  %-14s %12.1f %10.0f\n", name.c_str(), ms,
+                g.node_count() / (ms / 1e3));
+    std::printf("\n");
+
+    if (!same_distances(tree.distance, stepped.distance)) {
+        std::fprintf(stderr, "delta-stepping disagrees on %s\n",
+                     kind.c_str());
+        return false;
+    }
+    for (const auto &r : results) {
+        if (!same_distances(r, results.front())) {
+            std::fprintf(stderr, "algorithms disagree on %s\n", kind.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    // Show progress when piped, too.
+    std::setvbuf(stdout, nullptr, _IOLBF, 0);
+    std::uint32_t nodes = argc > 1 ? std::stoul(argv[1]) : 40000;
+    std::size_t queries = argc > 2 ? std::stoul(argv[2]) : 200;
+    std::vector<std::string> kinds(argv + std::min(argc, 3), argv + argc);
+    if (kinds.empty()) {
+        kinds = {"grid", "geometric", "erdos-renyi", "barabasi-albert",
+                 "road"};
+    }
+
+    try {
+        for (const std::string &kind : kinds) {
+            if (!run_kind(kind, nodes, queries)) {
+                return 1;
+            }
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "error: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
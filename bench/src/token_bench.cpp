@@ -0,0 +1,63 @@
+/*
+ * Tokenizer throughput on a generated DOT document.
+ *
+ * The document mixes plain names, quoted strings, numerals and attribute
+ * lists in roughly the proportions of a weighted graph with node positions.
+ * It is tokenized in place, the way a mapped input file would be.
+ */
+#include <graphd/input/token.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+
+using namespace graphd::input;
+
+static std::string document(int edges, std::mt19937 &rng) {
+    std::uniform_int_distribution<int> node{0, edges / 4};
+    std::uniform_real_distribution<double> weight{1.0, 10.0};
+    std::ostringstream out;
+    out << "strict graph bench {\n";
+    for (int i = 0; i < edges; i++) {
+        if (i % 8 == 0) {
+            out << "    \"n" << node(rng) << "\" [pos=\"" << weight(rng) << ","
+                << weight(rng) << "\"];\n";
+        }
+        out << "    n" << node(rng) << " -- n" << node(rng)
+            << " [weight=" << weight(rng) << "];\n";
+    }
+    out << "}\n";
+    return out.str();
+}
+
+int main() {
+    std::mt19937 rng{42};
+    std::printf("%10s %10s %12s %12s\n", "edges", "MiB", "time [ms]",
+                "MiB / s");
+
+    for (int edges = 1000; edges <= 1000000; edges *= 10) {
+        std::string doc = document(edges, rng);
+
+        auto start = std::chrono::steady_clock::now();
+        Tokenizer tok{doc};
+        std::size_t tokens = 0;
+        while (tok.next_token().type != TokenType::EOI) {
+            tokens++;
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        double mib = doc.size() / (1024.0 * 1024.0);
+        double ms =
+            std::chrono::duration<double, std::milli>(end - start).count();
+        std::printf("%10d %10.2f %12.3f %12.1f\n", edges, mib, ms,
+                    mib / (ms / 1e3));
+
+        if (tokens == 0) {
+            std::fprintf(stderr, "no tokens\n");
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+#ifndef _GRAPHD_ARRAY_H_
+#define _GRAPHD_ARRAY_H_
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace graphd {
+
+/**
+ * An array that either owns its elements or refers to memory kept alive
+ * elsewhere, typically a mapped snapshot file. This allows the same code to
+ * run on freshly built and on loaded data. Borrowed elements are read-only
+ * until they are copied on the first write.
+ */
+template <typename T> class Array {
+  public:
+    Array() = default;
+    Array(std::vector<T> elements)
+        : owned{std::move(elements)}, ptr{owned.data()}, len{owned.size()} {
+    }
+    /**
+     * Refer to size elements at data without taking ownership.
+     */
+    Array(const T *data, std::size_t size) : ptr{data}, len{size} {
+    }
+    Array(const Array &other)
+        : owned{other.owned}, ptr{other.borrowed() ? other.ptr : owned.data()},
+          len{other.len} {
+    }
+    // Moving a vector keeps its buffer, so ptr remains valid either way.
+    Array(Array &&other) noexcept
+        : owned{std::move(other.owned)}, ptr{other.ptr}, len{other.len} {
+        other.ptr = nullptr;
+        other.len = 0;
+    }
+    Array &operator=(Array other) noexcept {
+        std::swap(owned, other.owned);
+        std::swap(ptr, other.ptr);
+        std::swap(len, other.len);
+        return *this;
+    }
+
+    const T &operator[](std::size_t i) const {
+        return ptr[i];
+    }
+    const T *data() const {
+        return ptr;
+    }
+    std::size_t size() const {
+        return len;
+    }
+    bool empty() const {
+        return len == 0;
+    }
+    const T *begin() const {
+        return ptr;
+    }
+    const T *end() const {
+        return ptr + len;
+    }
+    const T &back() const {
+        return ptr[len - 1];
+    }
+    /**
+     * Writable access to the elements. Borrowed elements are copied first,
+     * memory kept alive elsewhere is never written to.
+     */
+    T *mutable_data() {
+        if (borrowed()) {
+            owned.assign(ptr, ptr + len);
+            ptr = owned.data();
+        }
+        return owned.data();
+    }
+
+  private:
+    bool borrowed() const {
+        return ptr != owned.data();
+    }
+
+    std::vector<T> owned;
+    const T *ptr = nullptr;
+    std::size_t len = 0;
+};
+
+} // namespace graphd
+
+#endif // _GRAPHD_ARRAY_H_
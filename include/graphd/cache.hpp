@@ -0,0 +1,87 @@
+#ifndef _GRAPHD_CACHE_H_
+#define _GRAPHD_CACHE_H_
+
+#include <graphd/graph.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace graphd {
+
+/**
+ * The results of recent queries against a graph whose edge weights may
+ * change, evicting the least recently used once capacity is reached. Paths
+ * are kept as node IDs. As edges are undirected, a result also answers the
+ * query in the opposite direction, with the path reversed.
+ *
+ * Whoever changes a weight reports it with edge_changed(), which drops only
+ * the results the change could affect: a longer or removed edge affects the
+ * paths that use it, a shorter edge of weight w also affects every path
+ * longer than w, as it may now be part of a shorter one.
+ *
+ * All methods lock, so the cache may be shared by concurrent queries.
+ */
+class QueryCache {
+  public:
+    QueryCache(const Graph &g, std::size_t capacity);
+    QueryCache(const QueryCache &) = delete;
+    QueryCache &operator=(const QueryCache &) = delete;
+
+    /**
+     * Number of lookups answered from the cache and not, since creation.
+     */
+    struct Counters {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+    };
+
+    std::optional<Path> find(const NodeName &from, const NodeName &to);
+    void insert(const NodeName &from, const NodeName &to, const Path &p);
+    /**
+     * Drop the results that may no longer be right now that the edge
+     * between n1 and n2 has changed from old_weight to new_weight.
+     */
+    void edge_changed(NodeName n1, NodeName n2, double old_weight,
+                      double new_weight);
+    void edge_changed(NodeId n1, NodeId n2, double old_weight,
+                      double new_weight);
+    std::size_t size() const;
+    Counters counters() const;
+    /**
+     * Drop all results, the counters are kept.
+     */
+    void clear();
+
+  private:
+    struct Entry {
+        double distance;
+        // The path from the lower to the higher node ID of the query
+        std::vector<NodeId> nodes;
+        // Position in the eviction order
+        std::list<std::uint64_t>::iterator age;
+    };
+
+    void erase(std::uint64_t key);
+
+    const Graph &g;
+    std::size_t capacity;
+    mutable std::mutex mutex;
+    Counters counts;
+    // Keyed by the lower and higher node ID of the query in the upper and
+    // lower half, like edges below
+    std::unordered_map<std::uint64_t, Entry> entries;
+    // Keys of all entries, least recently used first
+    std::list<std::uint64_t> order;
+    // Keys of the entries using each edge
+    std::unordered_map<std::uint64_t, std::unordered_set<std::uint64_t>> users;
+};
+
+} // namespace graphd
+
+#endif // _GRAPHD_CACHE_H_
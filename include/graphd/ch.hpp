@@ -0,0 +1,99 @@
+#ifndef _GRAPHD_CH_H_
+#define _GRAPHD_CH_H_
+
+#include <graphd/array.hpp>
+#include <graphd/graph.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace graphd {
+
+class SearchState;
+
+/**
+ * A contraction hierarchy over a frozen graph, for fast point-to-point
+ * queries once preprocessing has been paid for.
+ *
+ * Nodes are contracted one at a time in order of their edge difference (the
+ * number of shortcuts needed minus the number of edges removed). Whenever the
+ * only shortest path between two neighbors of a contracted node runs through
+ * it, a shortcut edge is inserted. A query then runs a bidirectional search
+ * that only ever moves towards nodes contracted later.
+ *
+ * The hierarchy refers to the graph it was built from, which needs to stay
+ * alive and unchanged. Queries after an edge weight change throw
+ * std::logic_error rather than return wrong paths.
+ */
+class ContractionHierarchy {
+  public:
+    explicit ContractionHierarchy(const Graph &g);
+    /**
+     * The shortest path between two nodes, with shortcuts unpacked into the
+     * original sequence of nodes. Concurrent queries are safe as long as each
+     * uses its own workspace.
+     */
+    Path shortest_path(NodeName from, NodeName to, SearchWorkspace &ws) const;
+    /**
+     * Distances from each source to each target, computed on the given
+     * number of threads. An upward search from every target leaves its
+     * distances in buckets at the nodes it settles; an upward search from
+     * every source then picks them up. Each pair costs a bucket scan rather
+     * than a search of its own.
+     */
+    DistanceMatrix distance_matrix(const std::vector<NodeName> &sources,
+                                   const std::vector<NodeName> &targets,
+                                   unsigned threads = 1) const;
+    const Graph &graph() const;
+    /**
+     * Number of shortcut edges added during preprocessing.
+     */
+    std::size_t shortcut_count() const;
+
+  private:
+    friend class Snapshot;
+    class Builder;
+
+    /**
+     * An empty hierarchy, to be filled in from a snapshot.
+     */
+    ContractionHierarchy(const Graph &g, std::shared_ptr<const void> storage);
+    /**
+     * Whether a higher neighbor offers a shorter way to n, settled in state,
+     * than the one it was reached on. No shortest path leads upwards through
+     * such a node.
+     */
+    bool stalled(NodeId n, const SearchState &state) const;
+    /**
+     * Search upwards from n until the queue runs dry, calling visit(node,
+     * distance) for each node settled and not stalled.
+     */
+    template <typename Visit>
+    void search_upwards(NodeId n, SearchState &state, Visit visit) const;
+    /**
+     * Throw unless the graph is still as it was during preprocessing.
+     */
+    void check_current() const;
+    std::uint64_t find_edge(NodeId n1, NodeId n2) const;
+    void unpack(NodeId from, NodeId to, std::vector<NodeId> &hops) const;
+
+    const Graph &g;
+    // Graph revision the hierarchy was built for
+    std::uint64_t revision;
+    // Position of each node in the contraction order
+    Array<NodeId> rank;
+    // Upward graph in CSR form: edges, original or shortcut, from each node
+    // to neighbors of higher rank. For shortcuts, middle holds the node
+    // whose contraction created them, no_node otherwise.
+    Array<std::uint64_t> offsets;
+    Array<NodeId> targets;
+    Array<double> weights;
+    Array<NodeId> middle;
+    // Keeps borrowed arrays alive, e.g. a mapped snapshot file.
+    std::shared_ptr<const void> storage;
+};
+
+} // namespace graphd
+
+#endif // _GRAPHD_CH_H_
@@ -1,17 +1,59 @@
 #ifndef _GRAPHD_GRAPH_H_
 #define _GRAPHD_GRAPH_H_
 
+#include <graphd/array.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
 namespace graphd {
 using NodeName = std::string;
-using DistMap = std::unordered_map<NodeName, double>;
+/**
+ * Dense node identifier, assigned in order of first appearance.
+ */
+using NodeId = std::uint32_t;
+using DistMap = std::unordered_map<NodeId, double>;
 
+/**
+ * Adjacency of a single node while the graph is being built.
+ */
 struct Node {
     DistMap neighbors;
-    void add_neighbor(NodeName n, double edge_weight);
+    void add_neighbor(NodeId n, double edge_weight);
+};
+
+struct SearchWorkspace;
+class DistanceMatrix;
+class Heuristic;
+class Snapshot;
+class ThreadPool;
+
+/**
+ * Coordinates of a node, as given by its "pos" attribute.
+ */
+struct Position {
+    double x;
+    double y;
+};
+
+/**
+ * Search strategies for point-to-point queries. All of them yield a shortest
+ * path; they differ in how much of the graph they explore to find it.
+ */
+enum class Algorithm {
+    // Grow a single search frontier from the start node
+    DIJKSTRA,
+    // Grow frontiers from both ends until they meet
+    BIDIRECTIONAL,
+    // Goal-directed search using the straight-line distance between node
+    // positions as a lower bound
+    ASTAR,
 };
 
 struct Path {
@@ -19,17 +61,208 @@ struct Path {
     std::vector<NodeName> nodes;
 };
 
+/**
+ * Shortest paths from one node to all others, indexed by node ID. Nodes not
+ * reachable from the root are at distance infinity and have no predecessor,
+ * neither does the root itself (both are no_node).
+ */
+struct ShortestPathTree {
+    NodeId root;
+    std::vector<double> distance;
+    // The node before n on a shortest path from the root to n.
+    std::vector<NodeId> predecessor;
+};
+
+/**
+ * An undirected, weighted graph.
+ *
+ * A graph is used in two phases: first it is built through add_edge(), then
+ * freeze() compacts the adjacency into compressed sparse row (CSR) form.
+ * Queries are only possible on a frozen graph, edges can only be added to a
+ * graph that is not yet frozen.
+ */
 class Graph {
   public:
-    Path shortest_path(NodeName from, NodeName to);
+    Path shortest_path(NodeName from, NodeName to) const;
+    /**
+     * Like shortest_path(from, to), but keeping all search state in ws.
+     * Concurrent queries are safe as long as each uses its own workspace.
+     */
+    Path shortest_path(NodeName from, NodeName to, SearchWorkspace &ws,
+                       Algorithm algorithm = Algorithm::DIJKSTRA) const;
+    /**
+     * A* search guided by the given heuristic.
+     */
+    Path shortest_path(NodeName from, NodeName to, SearchWorkspace &ws,
+                       const Heuristic &h) const;
+    /**
+     * Up to k loopless paths between two nodes, shortest first (Yen's
+     * algorithm). Spur paths are found by A* search guided by the tree of
+     * shortest paths to the target, or taken from that tree directly when it
+     * avoids the nodes and edges excluded for them. Throws if the nodes are
+     * not connected.
+     */
+    std::vector<Path> k_shortest_paths(NodeName from, NodeName to,
+                                       std::size_t k) const;
+    std::vector<Path> k_shortest_paths(NodeName from, NodeName to,
+                                       std::size_t k,
+                                       SearchWorkspace &ws) const;
+    /**
+     * Shortest paths from the given node to all nodes, found by a single
+     * search that only stops once every reachable node is settled.
+     */
+    ShortestPathTree shortest_path_tree(NodeName from) const;
+    ShortestPathTree shortest_path_tree(NodeId from, SearchWorkspace &ws) const;
+    /**
+     * The same distances, computed by delta-stepping on the threads of pool.
+     * Nodes are kept in buckets of width delta by tentative distance, and
+     * buckets are settled in order. Within a bucket, edges no longer than
+     * delta are relaxed in rounds until the bucket stays empty, the longer
+     * ones once it is settled. A delta of 0 picks the mean edge weight. The
+     * smaller delta, the closer this is to Dijkstra's algorithm, the larger,
+     * the closer to Bellman-Ford with more work but fewer rounds to
+     * synchronize.
+     *
+     * Predecessors may differ from those of shortest_path_tree() where
+     * several shortest paths exist.
+     */
+    ShortestPathTree shortest_path_tree(NodeId from, ThreadPool &pool,
+                                        double delta = 0) const;
+    /**
+     * Distances from each source to each target, running one search per
+     * source on the given number of threads. Each search stops as soon as
+     * all targets are settled.
+     */
+    DistanceMatrix distance_matrix(const std::vector<NodeName> &sources,
+                                   const std::vector<NodeName> &targets,
+                                   unsigned threads = 1) const;
     void set_name(std::string name);
+    /**
+     * The name given to the graph in its DOT document, if any.
+     */
+    const std::string &name() const;
     void add_edge(NodeName n1, NodeName n2, double distance = 1.0);
+    /**
+     * Make sure the node exists, even if it has no edges.
+     */
+    void add_node(NodeName n);
+    void set_position(NodeName n, Position pos);
+    /**
+     * Change the weight of the existing edge between n1 and n2 and return
+     * its previous weight. Works on frozen graphs too, where it must not run
+     * concurrently with queries and makes preprocessing built before, such
+     * as a contraction hierarchy, out of date.
+     *
+     * The topology stays the same: an edge of infinite weight is never
+     * taken, as if it had been removed, until it is given a finite weight
+     * again.
+     */
+    double set_edge_weight(NodeName n1, NodeName n2, double weight);
+    double set_edge_weight(NodeId n1, NodeId n2, double weight);
+    /**
+     * Set the weight of the edge between n1 and n2 to infinity.
+     */
+    double remove_edge(NodeName n1, NodeName n2);
+    /**
+     * Number of edge weight changes so far, to tell whether preprocessing
+     * is still up to date.
+     */
+    std::uint64_t revision() const;
+    /**
+     * Add everything in parts, which must not be frozen, as if it had been
+     * added to this graph part by part. Node IDs are assigned in the same
+     * order and duplicate edges keep the shortest distance. Edges are merged
+     * on the threads of pool.
+     */
+    void merge(std::vector<Graph> parts, ThreadPool &pool);
+    /**
+     * Compact the adjacency built so far into CSR form.
+     */
+    void freeze();
+    bool is_frozen() const;
+    /**
+     * Number of distinct nodes in the graph.
+     */
+    std::size_t node_count() const;
+    /**
+     * Number of (undirected) edges in the graph. Only valid once frozen.
+     */
+    std::size_t edge_count() const;
+    /**
+     * The position of node n, if it has one.
+     */
+    std::optional<Position> position(NodeId n) const;
+    /**
+     * The ID of the given node. Throws if there is no such node.
+     */
+    NodeId id_of(const NodeName &n) const;
+    /**
+     * The name of the node with the given ID.
+     */
+    std::string_view name_of(NodeId id) const;
+    /**
+     * The edges of node n are numbered edges_begin(n) <= e < edges_end(n).
+     * Only valid once frozen.
+     */
+    std::uint64_t edges_begin(NodeId n) const {
+        return offsets[n];
+    }
+    std::uint64_t edges_end(NodeId n) const {
+        return offsets[n + 1];
+    }
+    NodeId edge_target(std::uint64_t e) const {
+        return targets[e];
+    }
+    double edge_weight(std::uint64_t e) const {
+        return weights[e];
+    }
 
   private:
-    Path dijkstra(NodeName from, NodeName to);
-    // NOTE: Might well be useless for now.
-    std::string name;
-    std::unordered_map<NodeName, Node> nodes;
+    friend class Snapshot;
+
+    NodeId intern(NodeName n);
+    void freeze_names();
+    Path dijkstra(NodeId from, NodeId to, SearchWorkspace &ws) const;
+    Path bidirectional(NodeId from, NodeId to, SearchWorkspace &ws) const;
+    Path astar(NodeId from, NodeId to, SearchWorkspace &ws,
+               const Heuristic &h) const;
+    Path trace_path(NodeId from, NodeId to, const SearchWorkspace &ws) const;
+    /**
+     * The shortest path from spur to to that avoids the nodes excluded in ws
+     * and does not continue from spur to any of the given nodes. Requires
+     * ws.backward to hold a complete search from to. Returns the nodes after
+     * spur, or nothing if there is no such path.
+     */
+    std::optional<std::vector<NodeId>>
+    spur_path(NodeId spur, NodeId to, const std::vector<NodeId> &blocked,
+              SearchWorkspace &ws) const;
+    double edge_between(NodeId n1, NodeId n2) const;
+    std::runtime_error not_connected(NodeId from, NodeId to) const;
+    std::string graph_name;
+    // Builder state, released by freeze(). Symbol table:
+    // names[id_of(n)] == n
+    std::unordered_map<NodeName, NodeId> ids;
+    std::vector<NodeName> names;
+    std::vector<Position> node_positions;
+    std::vector<Node> nodes;
+    bool frozen = false;
+    std::uint64_t edits = 0;
+    // Frozen symbol table: the name of node n is the character range
+    // name_offsets[n] to name_offsets[n + 1] of name_chars. sorted_ids lists
+    // all nodes in order of their names, for lookup by binary search.
+    Array<std::uint64_t> name_offsets;
+    Array<char> name_chars;
+    Array<NodeId> sorted_ids;
+    // Node coordinates, NaN where unknown. Empty if no node has a position.
+    Array<Position> positions;
+    // CSR adjacency: the neighbors of node n are targets[i] at distance
+    // weights[i] for offsets[n] <= i < offsets[n + 1]. Each undirected edge
+    // appears once in either direction.
+    Array<std::uint64_t> offsets;
+    Array<NodeId> targets;
+    Array<double> weights;
+    // Keeps borrowed arrays alive, e.g. a mapped snapshot file.
+    std::shared_ptr<const void> storage;
 };
 } // namespace graphd
 
@@ -0,0 +1,68 @@
+#ifndef _GRAPHD_HEURISTIC_H_
+#define _GRAPHD_HEURISTIC_H_
+
+#include <graphd/graph.hpp>
+
+#include <memory>
+#include <string>
+
+namespace graphd {
+
+/**
+ * An estimate of the remaining distance between two nodes, guiding A* search.
+ *
+ * Estimates must never exceed the actual shortest distance (admissibility),
+ * otherwise A* may return paths that are not shortest.
+ */
+class Heuristic {
+  public:
+    virtual double estimate(NodeId from, NodeId to) const = 0;
+    /**
+     * Throw if the heuristic can no longer be relied on, e.g. because it was
+     * precomputed for a graph whose edges have changed since.
+     */
+    virtual void check_current() const {}
+    virtual ~Heuristic() = default;
+};
+
+/**
+ * Straight-line distance between node positions. Admissible as long as no
+ * edge is shorter than the distance between its endpoints. Nodes without a
+ * position are estimated at zero distance.
+ */
+class EuclideanHeuristic : public Heuristic {
+  public:
+    EuclideanHeuristic(const Graph &g);
+    virtual double estimate(NodeId from, NodeId to) const override;
+    virtual ~EuclideanHeuristic() = default;
+
+  private:
+    const Graph &graph;
+};
+
+/**
+ * Sum of coordinate differences between node positions. Only admissible if
+ * edges run parallel to the axes, as in grids; it then guides the search much
+ * better than the Euclidean distance.
+ */
+class ManhattanHeuristic : public Heuristic {
+  public:
+    ManhattanHeuristic(const Graph &g);
+    virtual double estimate(NodeId from, NodeId to) const override;
+    virtual ~ManhattanHeuristic() = default;
+
+  private:
+    const Graph &graph;
+};
+
+/**
+ * The heuristic with the given name, as used on the command line:
+ * "euclidean", "manhattan" or "landmarks" (a LandmarkHeuristic with the
+ * default number of landmarks). Throws on unknown names.
+ */
+std::unique_ptr<Heuristic> make_heuristic(const std::string &name,
+                                          const Graph &g);
+
+} // namespace graphd
+
+#endif // _GRAPHD_HEURISTIC_H_
@@ -0,0 +1,28 @@
+#ifndef _GRAPHD_LOAD_H_
+#define _GRAPHD_LOAD_H_
+
+#include <graphd/graph.hpp>
+#include <graphd/stats.hpp>
+
+#include <cstddef>
+#include <string_view>
+
+namespace graphd::input {
+
+/**
+ * Add the graph described by input to g, parsing it on the given number of
+ * threads. The statements are split into chunks of at least min_chunk_size
+ * bytes that are parsed on their own and merged in order; the result is the
+ * same as that of Parser::parse_into(). Inputs too small to be split are
+ * parsed serially, as are those found to be invalid, so that errors read the
+ * same in any case.
+ *
+ * Returns the effort spent parsing, summed over all chunks.
+ */
+ParseCounters parse_parallel(std::string_view input, Graph &g,
+                             unsigned threads,
+                             std::size_t min_chunk_size = 1 << 20);
+
+} // namespace graphd::input
+
+#endif // _GRAPHD_LOAD_H_
@@ -2,9 +2,13 @@
 #define _GRAPHD_PARSE_H_
 
 #include <graphd/graph.hpp>
+#include <graphd/input/parser/arena.hpp>
 #include <graphd/input/token.hpp>
+#include <graphd/stats.hpp>
 
+#include <cstdint>
 #include <istream>
+#include <string_view>
 #include <vector>
 
 namespace graphd::input {
@@ -21,7 +25,6 @@ enum class ExprType {
     ATTRIBUTE,
     A_LIST,
     ATTRIBUTE_LIST,
-    TOKEN_EXPR,
 };
 
 /**
@@ -40,40 +43,78 @@ class Expression {
     virtual ~Expression() = default;
 };
 
-typedef std::vector<Expression *> ParseStack;
-
 /**
- * A reduction to be performed on a parse stack.
+ * A table-driven LR parser for the subset of the DOT language we aim to
+ * support. The grammar and its parse table are found in parse.cpp.
+ *
+ * Expressions are allocated from arenas owned by the parser and released
+ * all at once along with it.
  */
-class Reduction {
+class Parser {
   public:
     /**
-     * Returns true if it succeeded, false otherwise.
-     * When false is returned, the stack was not altered.
+     * The expression tree of the entire input. It belongs to the parser and
+     * stays valid as long as both the parser and its input are alive.
      */
-    virtual bool perform(Token lookahead, ParseStack &s) = 0;
-    virtual ~Reduction() = default;
-};
-
-/**
- * A simple shift-reduce-type parser without a parsing table, completely
- * adequate for the subset of the DOT language we aim to support.
- */
-class Parser {
-  public:
     Expression *parse();
+    /**
+     * Parse the input and add its contents to g on the go. Unlike parse(),
+     * this never holds more than the statement currently being parsed. On
+     * error, g may contain part of the input.
+     */
+    void parse_into(Graph &g);
+    /**
+     * Like parse_into(), for input consisting of statements only, as found
+     * between the braces of a graph. The graph's name is left alone.
+     */
+    void parse_statements_into(Graph &g);
+    /**
+     * The effort spent parsing so far, if counters are compiled in.
+     */
+    const ParseCounters &counters() const {
+        return parse_counters;
+    }
     static Parser of(std::istream &in);
-    ~Parser();
+    /**
+     * A parser over a buffer holding the entire input, which needs to stay
+     * alive while parsing.
+     */
+    static Parser of(std::string_view input);
 
   private:
-    Parser(Tokenizer tokenizer, Token first_token,
-           std::vector<Reduction *> reductions);
-    bool shift();
-    bool reduce();
-    ParseStack stack;
-    Token lookahead;
+    /**
+     * A parser state along with the semantic value of the symbol that led
+     * to it: the token for terminals and graph names, an expression for all
+     * other symbols.
+     */
+    struct StackEntry {
+        std::uint8_t state;
+        Token token;
+        Expression *expr;
+    };
+
+    Parser(Tokenizer tokenizer);
+    /**
+     * Run the automaton from the states on the stack, or the initial state
+     * if it is empty. With fragment set, the end of input is taken for the
+     * closing brace of the graph first.
+     */
+    Expression *run(bool fragment = false);
+    /**
+     * Build the value of a rule's left-hand side from the values of the
+     * symbols on top of the stack.
+     */
+    StackEntry reduce(int rule);
+    std::vector<StackEntry> stack;
     Tokenizer tok;
-    std::vector<Reduction *> reductions;
+    // The graph and its statement list live in tree. Statements and their
+    // attributes live in statements, which can be released once they have
+    // been added to a graph.
+    Arena tree;
+    Arena statements;
+    // Where statements go as soon as they are parsed, if anywhere.
+    Graph *sink = nullptr;
+    ParseCounters parse_counters;
 };
 } // namespace graphd::input
 
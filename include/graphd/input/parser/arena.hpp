@@ -0,0 +1,41 @@
+#ifndef _GRAPHD_PARSER_ARENA_H_
+#define _GRAPHD_PARSER_ARENA_H_
+
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+namespace graphd::input {
+
+/**
+ * Bump allocator for parse-tree expressions. Memory is only ever released in
+ * bulk and destructors are never run: objects created here must not own
+ * memory from anywhere else. Containers can use resource() instead.
+ */
+class Arena {
+  public:
+    Arena() = default;
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    template <typename T, typename... Args> T *create(Args &&...args) {
+        void *p = memory.allocate(sizeof(T), alignof(T));
+        return new (p) T(std::forward<Args>(args)...);
+    }
+    std::pmr::memory_resource *resource() {
+        return &memory;
+    }
+    /**
+     * Release everything allocated so far, invalidating all objects.
+     */
+    void release() {
+        memory.release();
+    }
+
+  private:
+    std::pmr::monotonic_buffer_resource memory;
+};
+
+} // namespace graphd::input
+
+#endif // _GRAPHD_PARSER_ARENA_H_
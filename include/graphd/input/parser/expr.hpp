@@ -2,42 +2,28 @@
 #define _GRAPHD_PARSER_EXPR_H_
 
 #include <graphd/input/parse.hpp>
+#include <graphd/input/parser/arena.hpp>
 
+#include <memory_resource>
 #include <optional>
+#include <string_view>
+#include <vector>
 
+/*
+ * Expressions live in the parser's arenas. Names and values refer to the
+ * parser's input, nothing is owned or freed individually.
+ */
 namespace graphd::input::expr {
 
-typedef bool (*Predicate)(Expression *);
-
-class TokenExpr : public Expression {
-  public:
-    virtual ExprType type() override;
-    virtual void apply_to_graph(Graph &g) override;
-    virtual ~TokenExpr() = default;
-
-    static bool is_instance(Expression *e);
-    template <TokenType tt> static bool is_instance(Expression *e) {
-        if (e->type() != ExprType::TOKEN_EXPR) {
-            return false;
-        }
-        TokenExpr *asTok = static_cast<TokenExpr *>(e);
-        return asTok->token.type == tt;
-    }
-    TokenExpr(Token t);
-
-    Token token;
-};
-
 class Attribute : public Expression {
   public:
     static bool is_instance(Expression *e);
     virtual ExprType type() override;
     virtual void apply_to_graph(Graph &g) override;
-    virtual ~Attribute() = default;
-    Attribute(std::string attr_name, std::string attr_value);
+    Attribute(std::string_view attr_name, std::string_view attr_value);
 
-    std::string name;
-    std::string value;
+    std::string_view name;
+    std::string_view value;
 };
 
 class AttributeList : public Expression {
@@ -45,12 +31,11 @@ class AttributeList : public Expression {
     static bool is_instance(Expression *e);
     virtual ExprType type() override;
     virtual void apply_to_graph(Graph &g) override;
-    virtual ~AttributeList();
-    AttributeList(std::vector<Attribute *> &&attrs);
-    std::optional<std::string> get_attr(std::string name);
+    AttributeList(std::pmr::vector<Attribute *> &&attrs);
+    std::optional<std::string_view> get_attr(std::string_view name);
 
   private:
-    std::vector<Attribute *> attributes;
+    std::pmr::vector<Attribute *> attributes;
 };
 
 class AList : public Expression {
@@ -58,31 +43,40 @@ class AList : public Expression {
     static bool is_instance(Expression *e);
     virtual ExprType type() override;
     virtual void apply_to_graph(Graph &g) override;
-    virtual ~AList();
+    AList(std::pmr::memory_resource *memory);
     void add_attribute(Attribute *attr);
-    AttributeList *as_attr_list();
+    AttributeList *as_attr_list(Arena &arena);
 
   private:
-    std::vector<Attribute *> attributes;
+    std::pmr::vector<Attribute *> attributes;
 };
 
 class Statement : public Expression {
   public:
     static bool is_instance(Expression *e);
-    virtual ~Statement() = default;
 };
 
 class EdgeStmt : public Statement {
   public:
     virtual ExprType type() override;
     virtual void apply_to_graph(Graph &g) override;
-    virtual ~EdgeStmt();
-    EdgeStmt(std::string n1name, std::string n2name,
+    EdgeStmt(std::string_view n1name, std::string_view n2name,
              AttributeList *attrs = nullptr);
 
   private:
-    std::string node1_name;
-    std::string node2_name;
+    std::string_view node1_name;
+    std::string_view node2_name;
+    AttributeList *attr_list;
+};
+
+class NodeStmt : public Statement {
+  public:
+    virtual ExprType type() override;
+    virtual void apply_to_graph(Graph &g) override;
+    NodeStmt(std::string_view name, AttributeList *attrs = nullptr);
+
+  private:
+    std::string_view node_name;
     AttributeList *attr_list;
 };
 
@@ -90,14 +84,17 @@ class StmtList : public Expression {
   public:
     virtual ExprType type() override;
     virtual void apply_to_graph(Graph &g) override;
-    virtual ~StmtList();
-    StmtList();
+    StmtList(std::pmr::memory_resource *memory);
     void add_statement(Statement *s);
+    /**
+     * Apply the statements gathered so far to g and forget about them.
+     */
+    void flush_into(Graph &g);
 
     static bool is_instance(Expression *e);
 
   private:
-    std::vector<Statement *> statements;
+    std::pmr::vector<Statement *> statements;
 };
 
 class FullGraph : public Expression {
@@ -106,15 +103,12 @@ class FullGraph : public Expression {
         return ExprType::GRAPH;
     }
     virtual void apply_to_graph(Graph &g) override;
-    virtual ~FullGraph() {
-        delete stmtList;
-    }
-    FullGraph(std::string name, StmtList *stmtList);
+    FullGraph(std::string_view name, StmtList *stmtList);
 
     static bool is_instance(Expression *e);
 
   private:
-    std::string name;
+    std::string_view name;
     StmtList *stmtList;
 };
 } // namespace graphd::input::expr
@@ -2,7 +2,10 @@
 #define _GRAPHD_TOKEN_H_
 
 #include <istream>
+#include <list>
+#include <memory>
 #include <string>
+#include <string_view>
 
 namespace graphd::input {
 enum class TokenType {
@@ -24,33 +27,60 @@ enum class TokenType {
     // that are not yet supported.
 };
 
+/**
+ * A token, its value usually being a slice of the tokenizer's input. Keywords
+ * and fixed tokens refer to static storage instead.
+ */
 struct Token {
     TokenType type;
-    std::string value;
+    std::string_view value;
     /**
      * Whether this token can represent an identifier.
      */
     bool is_identifier();
     static Token from(char c);
-    static Token from(std::string s);
+    static Token from(std::string_view s);
 };
 
+/**
+ * Splits a contiguous input buffer into tokens without copying it. Values of
+ * the tokens returned stay valid as long as both the input and the tokenizer
+ * are alive. Only quoted strings containing escapes need to be copied; the
+ * tokenizer keeps those copies.
+ */
 class Tokenizer {
   public:
     /**
-     * @param in Input source from which to fetch tokens.
+     * @param in Input source from which to fetch tokens. It is read entirely
+     * into a buffer owned by the tokenizer.
      */
     Tokenizer(std::istream &in);
     /**
-     * The next token from the input stream.
+     * @param input Buffer holding the entire input, e.g. a mapped file.
+     */
+    Tokenizer(std::string_view input);
+    Tokenizer(Tokenizer &&) = default;
+    /**
+     * The next token from the input.
      */
     Token next_token();
+    /**
+     * Offset into the input of the first character not yet tokenized.
+     */
+    std::size_t position() const {
+        return pos;
+    }
 
   private:
-    std::string read_string();
-    std::string read_name();
-    std::string read_numeral();
-    std::istream &in;
+    std::string_view read_string();
+    std::string_view read_name();
+    std::string_view read_numeral();
+    // Held by pointer so that moving the tokenizer keeps token values valid.
+    std::unique_ptr<const std::string> buffer;
+    std::string_view input;
+    std::size_t pos = 0;
+    // Unescaped copies of quoted strings. List nodes do not move.
+    std::list<std::string> unescaped;
 };
 } // namespace graphd::input
 
@@ -0,0 +1,71 @@
+#ifndef _GRAPHD_LANDMARKS_H_
+#define _GRAPHD_LANDMARKS_H_
+
+#include <graphd/array.hpp>
+#include <graphd/graph.hpp>
+#include <graphd/heuristic.hpp>
+
+#include <cstdint>
+#include <memory>
+
+namespace graphd {
+
+/**
+ * Lower bounds from distances to a few landmark nodes (ALT: A*, landmarks,
+ * triangle inequality), for graphs without coordinates.
+ *
+ * For any landmark L, the triangle inequality gives
+ * |d(L, to) - d(L, from)| <= d(from, to), so the largest such difference is
+ * an admissible and consistent estimate. Landmarks are picked one by one as
+ * the node farthest from all landmarks picked before, which places them on
+ * the periphery of the graph where their bounds are tightest. Each needs a
+ * full single-source search during preprocessing and a distance per node.
+ *
+ * The heuristic refers to the graph it was built from, which needs to stay
+ * alive. Once any edge weight changes it is out of date: a shorter edge can
+ * make its bounds overestimate. check_current() then throws, and so do
+ * searches guided by it, until it is rebuilt.
+ */
+class LandmarkHeuristic : public Heuristic {
+  public:
+    static constexpr unsigned default_count = 16;
+
+    /**
+     * Pick up to count landmarks in g, fewer if g has fewer nodes.
+     */
+    LandmarkHeuristic(const Graph &g, unsigned count = default_count);
+    virtual double estimate(NodeId from, NodeId to) const override;
+    /**
+     * Throw unless the graph is still as it was during preprocessing.
+     */
+    virtual void check_current() const override;
+    virtual ~LandmarkHeuristic() = default;
+    const Graph &graph() const;
+    /**
+     * The landmark nodes, in the order they were picked.
+     */
+    const Array<NodeId> &landmarks() const;
+
+  private:
+    friend class Snapshot;
+
+    /**
+     * An empty heuristic, to be filled in from a snapshot.
+     */
+    LandmarkHeuristic(const Graph &g, std::shared_ptr<const void> storage);
+
+    const Graph &g;
+    // Graph revision the landmarks were picked for
+    std::uint64_t revision;
+    Array<NodeId> nodes;
+    // distances[n * nodes.size() + i] is the distance between node n and
+    // landmark i, infinity if they are not connected. Landmarks of a node
+    // are adjacent so that an estimate reads a single cache line or two.
+    Array<double> distances;
+    // Keeps borrowed arrays alive, e.g. a mapped snapshot file.
+    std::shared_ptr<const void> storage;
+};
+
+} // namespace graphd
+
+#endif // _GRAPHD_LANDMARKS_H_
@@ -0,0 +1,33 @@
+#ifndef _GRAPHD_MAPPED_FILE_H_
+#define _GRAPHD_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+
+namespace graphd {
+
+/**
+ * A read-only memory mapping of an entire file. Pages are only read from
+ * disk once they are accessed.
+ */
+class MappedFile {
+  public:
+    /**
+     * Map the file at path. Throws if it cannot be opened or mapped.
+     */
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data() const;
+    std::size_t size() const;
+
+  private:
+    const char *addr = nullptr;
+    std::size_t len = 0;
+};
+
+} // namespace graphd
+
+#endif // _GRAPHD_MAPPED_FILE_H_
@@ -0,0 +1,55 @@
+#ifndef _GRAPHD_MATRIX_H_
+#define _GRAPHD_MATRIX_H_
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+namespace graphd {
+
+/**
+ * Shortest distances from a list of sources (rows) to a list of targets
+ * (columns), stored densely in row-major order. Unreachable targets are at
+ * distance infinity.
+ */
+class DistanceMatrix {
+  public:
+    DistanceMatrix(std::size_t rows, std::size_t columns);
+    std::size_t rows() const {
+        return row_count;
+    }
+    std::size_t columns() const {
+        return column_count;
+    }
+    double &at(std::size_t row, std::size_t column) {
+        return distances[row * column_count + column];
+    }
+    double at(std::size_t row, std::size_t column) const {
+        return distances[row * column_count + column];
+    }
+    /**
+     * All distances, row by row.
+     */
+    const double *data() const {
+        return distances.data();
+    }
+    /**
+     * Write the number of rows and columns as 64-bit unsigned integers,
+     * followed by the distances as 64-bit doubles, row by row. Everything is
+     * in native byte order.
+     */
+    void write_binary(std::ostream &out) const;
+    /**
+     * Write one line per row, distances separated by tabs.
+     */
+    void write_text(std::ostream &out) const;
+
+  private:
+    std::size_t row_count;
+    std::size_t column_count;
+    std::vector<double> distances;
+};
+
+} // namespace graphd
+
+#endif // _GRAPHD_MATRIX_H_
@@ -0,0 +1,51 @@
+#ifndef _GRAPHD_POOL_H_
+#define _GRAPHD_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace graphd {
+
+/**
+ * A fixed set of worker threads processing a shared queue of tasks.
+ *
+ * Each task is told the index of the worker running it, so that it can use
+ * per-worker state such as a SearchWorkspace without further locking.
+ */
+class ThreadPool {
+  public:
+    using Task = std::function<void(unsigned worker)>;
+
+    explicit ThreadPool(unsigned threads);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned size() const;
+    void submit(Task task);
+    /**
+     * Block until all submitted tasks have finished. Rethrows the first
+     * exception thrown by any of them.
+     */
+    void wait();
+
+  private:
+    void work(unsigned worker);
+    std::vector<std::thread> workers;
+    std::deque<Task> tasks;
+    std::mutex mutex;
+    std::condition_variable task_ready;
+    std::condition_variable all_done;
+    std::size_t pending = 0;
+    std::exception_ptr failure;
+    bool stopping = false;
+};
+
+} // namespace graphd
+
+#endif // _GRAPHD_POOL_H_
@@ -0,0 +1,116 @@
+#ifndef _GRAPHD_QUERY_H_
+#define _GRAPHD_QUERY_H_
+
+#include <graphd/cache.hpp>
+#include <graphd/ch.hpp>
+#include <graphd/graph.hpp>
+#include <graphd/matrix.hpp>
+#include <graphd/stats.hpp>
+
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace graphd {
+
+/**
+ * A single from/to pair to be answered against a graph.
+ */
+struct Query {
+    NodeName from;
+    NodeName to;
+};
+
+/**
+ * How to answer a batch of queries.
+ */
+struct BatchOptions {
+    unsigned threads = 1;
+    Algorithm algorithm = Algorithm::DIJKSTRA;
+    // If set, queries use A* search guided by this heuristic instead of the
+    // chosen algorithm.
+    const Heuristic *heuristic = nullptr;
+    // If set, queries are answered using this contraction hierarchy, which
+    // must have been built for the queried graph.
+    const ContractionHierarchy *hierarchy = nullptr;
+    // If set, results are looked up in and added to this cache, which must
+    // have been created for the queried graph.
+    QueryCache *cache = nullptr;
+    // If set, run_batch adds the effort of its searches to this once done.
+    SearchCounters *counters = nullptr;
+};
+
+/**
+ * Answer a single query according to the options, from the cache if they
+ * name one and it holds the result.
+ */
+Path answer_query(const Graph &g, const Query &q, SearchWorkspace &ws,
+                  const BatchOptions &options);
+
+/**
+ * The algorithm with the given name, as used on the command line:
+ * "dijkstra", "bidirectional" or "astar". Throws on unknown names.
+ */
+Algorithm parse_algorithm(const std::string &name);
+
+/**
+ * Parse a query line of the form "from-node to-node". Returns nothing for
+ * blank lines, throws on malformed ones.
+ */
+std::optional<Query> parse_query(const std::string &line);
+
+/**
+ * Read a list of nodes, one per line. Blank lines are skipped, lines with
+ * more than one name are an error.
+ */
+std::vector<NodeName> read_nodes(std::istream &in);
+
+/**
+ * Append the result of a query to out, as a single line:
+ * the total distance and the path separated by a tab, or an error message.
+ */
+void format_path(std::string &out, const Path &p);
+void format_error(std::string &out, const std::string &msg);
+
+/**
+ * Answer the query on a single input line and append the result to out as
+ * formatted above. Blank lines add nothing, failed queries add an error.
+ */
+void answer_line(const Graph &g, const std::string &line, SearchWorkspace &ws,
+                 const BatchOptions &options, std::string &out);
+
+/**
+ * Answer all queries read from in, one per line, against g. Results are
+ * written to out in input order. Output is buffered internally and only
+ * written out in large chunks.
+ *
+ * With more than one thread, queries are read in blocks whose results are
+ * computed in parallel and then written in order, so output is the same
+ * regardless of the number of threads.
+ */
+void run_batch(const Graph &g, std::istream &in, std::ostream &out,
+               const BatchOptions &options = {});
+
+/**
+ * Distances from each source to each target, using the hierarchy if the
+ * options name one and the plain graph otherwise. Heuristics and the choice
+ * of algorithm do not apply.
+ */
+DistanceMatrix answer_matrix(const Graph &g,
+                             const std::vector<NodeName> &sources,
+                             const std::vector<NodeName> &targets,
+                             const BatchOptions &options);
+
+/**
+ * Write the nodes reachable in tree to out in order of their IDs, one per
+ * line: the node, its distance from the root and its predecessor, separated
+ * by tabs. The predecessor is left empty for the root.
+ */
+void write_tree(const Graph &g, const ShortestPathTree &tree,
+                std::ostream &out);
+
+} // namespace graphd
+
+#endif // _GRAPHD_QUERY_H_
@@ -0,0 +1,166 @@
+#ifndef _GRAPHD_SERVER_H_
+#define _GRAPHD_SERVER_H_
+
+#include <graphd/graph.hpp>
+#include <graphd/pool.hpp>
+#include <graphd/query.hpp>
+#include <graphd/workspace.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graphd {
+
+/**
+ * A graph as served: the options to answer queries with, which may refer to
+ * a hierarchy, heuristic or cache built for it, and whatever keeps all of
+ * them alive.
+ */
+struct ServedGraph {
+    const Graph *graph;
+    BatchOptions options;
+    std::shared_ptr<const void> storage;
+};
+
+/**
+ * Answers queries against a loaded graph over a Unix domain socket, so that
+ * the graph is loaded once rather than per query.
+ *
+ * The protocol is the one of query files: clients send lines of the form
+ * "from-node to-node" and get one line back for each, formatted like the
+ * output of run_batch, in the order the queries were sent. Blank lines are
+ * ignored. Clients may send many queries without waiting for the answers.
+ *
+ * A single thread waits for all sockets with epoll, reading queries and
+ * writing answers without blocking. Complete lines are handed to a pool of
+ * workers, one batch per connection at a time so that answers stay in
+ * order, while other connections are served by other workers.
+ *
+ * The graph can be replaced while serving. A new one is loaded on a thread
+ * of its own while queries go on, and is then published by the event loop
+ * for all batches dispatched from then on. Each batch holds a reference to
+ * the graph it was dispatched with, so workers never wait for a lock to get
+ * at it, and an old graph is freed once the last batch using it finishes.
+ */
+class Server {
+  public:
+    /**
+     * Listen on a socket at path, replacing a stale socket file left there
+     * by an earlier run. Throws if another server still listens there.
+     * Queries are answered according to options, on options.threads
+     * workers.
+     */
+    Server(const Graph &g, const std::string &path,
+           const BatchOptions &options = {});
+    /**
+     * Serve graph, and on reload() replace it with what load returns.
+     * Queries run on graph.options.threads workers for all graphs served.
+     */
+    Server(ServedGraph graph, const std::string &path,
+           std::function<ServedGraph()> load = {});
+    ~Server();
+    Server(const Server &) = delete;
+    Server &operator=(const Server &) = delete;
+
+    /**
+     * Serve clients until stop() is called.
+     */
+    void run();
+    /**
+     * Make run() return soon. Safe to call from other threads and from
+     * signal handlers.
+     */
+    void stop();
+    /**
+     * Load a new graph in the background and serve it once loaded. If
+     * loading throws, the current graph is kept. Requests made while
+     * loading are served by a single further load. Safe to call from other
+     * threads and from signal handlers, ignored without a loader.
+     */
+    void reload();
+
+  private:
+    struct Connection {
+        int fd;
+        // Received, not yet answered
+        std::string in;
+        // Answered, not yet sent
+        std::string out;
+        // Events the connection is watched for
+        std::uint32_t events;
+        // Whether a batch of this connection's queries is being answered
+        bool busy = false;
+        // Whether the client has finished sending
+        bool eof = false;
+        // Whether the connection is beyond use and to be closed right away
+        bool failed = false;
+    };
+
+    void accept_clients();
+    void receive(Connection &c);
+    void send(Connection &c);
+    /**
+     * Hand the complete lines received on c to a worker, unless it is
+     * still busy with earlier ones.
+     */
+    void dispatch(std::uint64_t id, Connection &c);
+    /**
+     * Collect the answers of finished batches.
+     */
+    void collect();
+    /**
+     * Close c if nothing is left to do for it, otherwise watch it for the
+     * events it is waiting for.
+     */
+    void update(std::uint64_t id, Connection &c);
+    void close_connection(std::uint64_t id);
+    /**
+     * Start loading a new graph unless already loading.
+     */
+    void start_loading();
+    /**
+     * Serve the graph loaded, if any.
+     */
+    void publish();
+
+    // The graph new batches are answered with, only used by the event loop
+    std::shared_ptr<const ServedGraph> current;
+    std::function<ServedGraph()> load;
+    std::string path;
+    int listener = -1;
+    int poller = -1;
+    // Signals finished batches and loads, and stop and reload requests.
+    int wakeup = -1;
+    std::atomic<bool> stopping = false;
+    std::atomic<bool> reload_requested = false;
+    // Connections by ID, which is never reused so that answers for a
+    // connection closed meanwhile are not sent on a new one.
+    std::unordered_map<std::uint64_t, Connection> connections;
+    std::uint64_t next_id = 0;
+
+    std::vector<SearchWorkspace> workspaces;
+    // Answers of finished batches, by connection ID
+    std::mutex finished_mutex;
+    std::deque<std::pair<std::uint64_t, std::string>> finished;
+    // Set by the loader thread, if a load succeeded
+    std::shared_ptr<const ServedGraph> loaded;
+    // Whether the loader thread is done
+    bool load_finished = false;
+    std::thread loader;
+    // Declared last: its workers need all of the above until joined.
+    ThreadPool pool;
+};
+
+} // namespace graphd
+
+#endif // _GRAPHD_SERVER_H_
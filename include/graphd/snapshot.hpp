@@ -0,0 +1,68 @@
+#ifndef _GRAPHD_SNAPSHOT_H_
+#define _GRAPHD_SNAPSHOT_H_
+
+#include <graphd/ch.hpp>
+#include <graphd/graph.hpp>
+#include <graphd/landmarks.hpp>
+
+#include <memory>
+#include <ostream>
+#include <string>
+
+namespace graphd {
+
+/**
+ * A frozen graph and its preprocessing, stored in a binary file that can be
+ * mapped into memory instead of being parsed and built again.
+ *
+ * A snapshot file starts with a header (magic bytes, format version, a byte
+ * order mark and the number of sections), followed by a table giving kind,
+ * offset and size of each section. Every section holds one array, such as
+ * the node names or the CSR adjacency, 8-byte aligned so that it can be used
+ * in place. Sections of unknown kind are skipped, new kinds of preprocessing
+ * can be added without breaking existing files.
+ *
+ * Loading only checks that the sections fit together, not each of their
+ * entries: that would mean reading the whole file up front.
+ */
+class Snapshot {
+  public:
+    /**
+     * Write g, and the hierarchy and landmarks built over it if given.
+     */
+    static void write(std::ostream &out, const Graph &g,
+                      const ContractionHierarchy *ch = nullptr,
+                      const LandmarkHeuristic *landmarks = nullptr);
+    /**
+     * Map the snapshot at path into memory. Throws if it is not a valid
+     * snapshot.
+     */
+    static Snapshot load(const std::string &path);
+    /**
+     * Whether the file at path looks like a snapshot, judging by its magic
+     * bytes.
+     */
+    static bool is_snapshot(const std::string &path);
+
+    const Graph &graph() const;
+    /**
+     * The stored contraction hierarchy, nullptr if there is none.
+     */
+    const ContractionHierarchy *hierarchy() const;
+    /**
+     * The stored landmarks, nullptr if there are none.
+     */
+    const LandmarkHeuristic *landmarks() const;
+
+  private:
+    Snapshot() = default;
+
+    // Held by pointer for stable addresses: the hierarchy refers to the graph.
+    std::unique_ptr<Graph> g;
+    std::unique_ptr<ContractionHierarchy> ch;
+    std::unique_ptr<LandmarkHeuristic> alt;
+};
+
+} // namespace graphd
+
+#endif // _GRAPHD_SNAPSHOT_H_
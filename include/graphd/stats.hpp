@@ -0,0 +1,106 @@
+#ifndef _GRAPHD_STATS_H_
+#define _GRAPHD_STATS_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * Counters of parsing and search effort are only compiled in with
+ * GRAPHD_STATS defined, e.g. by building with make STATS=1. Otherwise they
+ * stay zero, and the statements that would update them are not compiled at
+ * all, so they cost nothing.
+ */
+#ifdef GRAPHD_STATS
+#define GRAPHD_COUNT(...) __VA_ARGS__
+#else
+#define GRAPHD_COUNT(...)
+#endif
+
+namespace graphd {
+
+#ifdef GRAPHD_STATS
+constexpr bool counters_enabled = true;
+#else
+constexpr bool counters_enabled = false;
+#endif
+
+/**
+ * The effort of searches: nodes settled, paths offered to nodes (one per
+ * edge relaxed and one per search, whether or not they were improvements),
+ * and entries pushed onto and popped off the heap, stale ones included.
+ */
+struct SearchCounters {
+    std::uint64_t settled = 0;
+    std::uint64_t relaxed = 0;
+    std::uint64_t pushes = 0;
+    std::uint64_t pops = 0;
+
+    SearchCounters &operator+=(const SearchCounters &other) {
+        settled += other.settled;
+        relaxed += other.relaxed;
+        pushes += other.pushes;
+        pops += other.pops;
+        return *this;
+    }
+};
+
+/**
+ * The effort of parsing: tokens read, the deepest the parse stack got, and
+ * the time spent adding statements to the graph, as opposed to tokenizing
+ * and parsing them. Times of parallel parsers add up.
+ */
+struct ParseCounters {
+    std::uint64_t tokens = 0;
+    std::size_t max_stack_depth = 0;
+    double statement_ms = 0;
+
+    ParseCounters &operator+=(const ParseCounters &other) {
+        tokens += other.tokens;
+        max_stack_depth = std::max(max_stack_depth, other.max_stack_depth);
+        statement_ms += other.statement_ms;
+        return *this;
+    }
+};
+
+/**
+ * What a run of graphd reports: wall time per phase, the size of the graph
+ * and, if compiled in, the counters above.
+ */
+class RunStats {
+  public:
+    /**
+     * End the current phase, if any, and start timing the next one.
+     */
+    void start_phase(std::string name);
+    /**
+     * End the current phase, if any.
+     */
+    void end_phase();
+    /**
+     * Write everything as a single JSON object. Phases are listed in the
+     * order they ran, with times in milliseconds.
+     */
+    void write_json(std::ostream &out) const;
+
+    std::size_t nodes = 0;
+    std::size_t edges = 0;
+    ParseCounters parse;
+    SearchCounters search;
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<std::pair<std::string, double>> phases;
+    std::string phase;
+    Clock::time_point phase_start;
+};
+
+} // namespace graphd
+
+#endif // _GRAPHD_STATS_H_
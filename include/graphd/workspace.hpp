@@ -0,0 +1,104 @@
+#ifndef _GRAPHD_WORKSPACE_H_
+#define _GRAPHD_WORKSPACE_H_
+
+#include <graphd/graph.hpp>
+#include <graphd/stats.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace graphd {
+
+constexpr double infinity = std::numeric_limits<double>::infinity();
+constexpr NodeId no_node = std::numeric_limits<NodeId>::max();
+
+/**
+ * The state of a single search frontier: tentative distances, parent
+ * pointers and a binary min-heap with lazy deletion.
+ *
+ * Arrays are sized once per graph and reused across searches. Resetting only
+ * touches the nodes reached by the previous search, so a query that settles
+ * few nodes stays cheap on a large graph.
+ */
+class SearchState {
+  public:
+    /**
+     * Prepare for a new search on a graph with the given number of nodes.
+     */
+    void reset(std::size_t node_count);
+    double distance(NodeId n) const {
+        return distances[n];
+    }
+    NodeId parent(NodeId n) const {
+        return parents[n];
+    }
+    bool settled(NodeId n) const {
+        return priorities[n] == -infinity;
+    }
+    /**
+     * Offer a path of length dist to n, reaching it from parent. Returns true
+     * and queues n with the given priority if the path is an improvement.
+     */
+    bool relax(NodeId n, double dist, NodeId parent, double priority);
+    bool relax(NodeId n, double dist, NodeId parent) {
+        return relax(n, dist, parent, dist);
+    }
+    /**
+     * Remove stale entries from the top of the heap. Returns false if no
+     * live entries are left.
+     */
+    bool has_next();
+    /**
+     * Priority of the next node to be settled. Requires has_next().
+     */
+    double next_priority() const {
+        return heap.front().first;
+    }
+    /**
+     * Settle the next node and return it. Requires has_next().
+     */
+    NodeId pop();
+
+    // Effort of all searches run with this state, if counters are compiled
+    // in. Not touched by reset().
+    SearchCounters counters;
+
+  private:
+    using Entry = std::pair<double, NodeId>;
+    std::vector<double> distances;
+    std::vector<NodeId> parents;
+    // Priority of the live heap entry for each node, to detect stale ones
+    std::vector<double> priorities;
+    std::vector<NodeId> touched;
+    std::vector<Entry> heap;
+};
+
+/**
+ * Everything a query needs, owned by the caller so that concurrent queries
+ * on the same graph each use their own and repeated queries don't allocate.
+ */
+struct SearchWorkspace {
+    SearchState forward;
+    // Only used by bidirectional searches, and by k shortest paths searches
+    // for the tree of shortest paths to the target
+    SearchState backward;
+    // Nodes n with excluded[n] == exclusion are off limits to k shortest
+    // paths searches. Bumping exclusion lifts all exclusions at once.
+    std::vector<std::uint32_t> excluded;
+    std::uint32_t exclusion = 0;
+
+    /**
+     * Effort of all searches run with this workspace.
+     */
+    SearchCounters counters() const {
+        SearchCounters total = forward.counters;
+        total += backward.counters;
+        return total;
+    }
+};
+
+} // namespace graphd
+
+#endif // _GRAPHD_WORKSPACE_H_
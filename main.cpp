@@ -1,55 +1,639 @@
+#include <graphd/cache.hpp>
+#include <graphd/ch.hpp>
 #include <graphd/graph.hpp>
-#include <graphd/input/parse.hpp>
+#include <graphd/heuristic.hpp>
+#include <graphd/input/load.hpp>
+#include <graphd/landmarks.hpp>
+#include <graphd/mapped_file.hpp>
+#include <graphd/matrix.hpp>
+#include <graphd/pool.hpp>
+#include <graphd/query.hpp>
+#include <graphd/server.hpp>
+#include <graphd/snapshot.hpp>
+#include <graphd/stats.hpp>
+#include <graphd/workspace.hpp>
 
+#include <csignal>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <optional>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include <getopt.h>
 
 void usage(std::string progname) {
-    std::cerr << "usage: " << progname << " [-f file.dot] from-node to-node\n"
-              << "  if no input file is specified, stdin is assumed.\n";
+    std::cerr << "usage: " << progname
+              << " [-f file.dot] [-a algorithm] [-H heuristic] from-node "
+                 "to-node\n"
+              << "       " << progname
+              << " [-f file.dot] -k K from-node to-node\n"
+              << "       " << progname
+              << " [-f file.dot] [-a algorithm] [-H heuristic] [-j N] [-c N] "
+                 "-q queries\n"
+              << "       " << progname
+              << " [-f file.dot] [-j N [--delta D]] -s from-node\n"
+              << "       " << progname
+              << " [-f file.dot] [-a algorithm] [-H heuristic] [-j N] [-c N] "
+                 "--serve socket\n"
+              << "       " << progname
+              << " [-f file.dot] [-a ch] [-j N] -m sources [-t targets] "
+                 "[-o file]\n"
+              << "  any of the above with --stats[=file] reports time spent\n"
+              << "     per phase, graph size and, if built with STATS=1,\n"
+              << "     search and parse counters as JSON, to stderr by\n"
+              << "     default. Searches of -s with -j are not counted.\n"
+              << "  if no input file is specified, stdin is assumed.\n"
+              << "  -a selects the search algorithm: dijkstra (default),\n"
+              << "     bidirectional, astar, alt (astar -H landmarks) or ch\n"
+              << "     (contraction hierarchies).\n"
+              << "  -H selects the heuristic for astar: euclidean (default) or\n"
+              << "     manhattan, based on node \"pos\" attributes, or\n"
+              << "     landmarks, based on distances to -L N landmarks\n"
+              << "     (default: 16) picked during preprocessing.\n"
+              << "  -q reads from/to pairs from a file, one per line;\n"
+              << "     use -q - to read them from stdin.\n"
+              << "  -c keeps the results of up to N recent queries to\n"
+              << "     answer repeated ones, in either direction, without a\n"
+              << "     search.\n"
+              << "  -k prints up to K loopless paths from from-node to\n"
+              << "     to-node, shortest first, one per line.\n"
+              << "  -s prints the distance from from-node to every node it\n"
+              << "     reaches, along with the node before it on a shortest\n"
+              << "     path. With -j, the search runs on N threads by\n"
+              << "     delta-stepping, in buckets --delta D wide (default:\n"
+              << "     the mean edge weight).\n"
+              << "  -m computes the distances from each node listed in the\n"
+              << "     sources file to each node listed in the targets file\n"
+              << "     (default: the sources), one node per line. Rows are\n"
+              << "     printed as text, or written to the file given with\n"
+              << "     -o in binary.\n"
+              << "  --serve answers queries sent as from/to lines to a Unix\n"
+              << "     domain socket at the given path, one line each, until\n"
+              << "     terminated. SIGHUP reloads the graph file.\n"
+              << "  -j loads the graph and answers queries on N threads\n"
+              << "     (default: 1).\n"
+              << "  -w writes the graph, and its hierarchy with -a ch or its\n"
+              << "     landmarks with -H landmarks, to a snapshot file.\n"
+              << "     Snapshots given to -f are loaded without parsing;\n"
+              << "     from/to nodes are optional with -w.\n";
 }
 
-int run(std::istream &in, int argc, char **argv) {
-    if (optind > argc - 2) {
-        usage(argv[0]);
-        return EXIT_FAILURE;
+/**
+ * Start timing the next phase, if stats are to be reported.
+ */
+void start_phase(graphd::RunStats *stats, std::string name) {
+    if (stats != nullptr) {
+        stats->start_phase(std::move(name));
     }
+}
 
-    graphd::NodeName from_node = argv[optind];
-    graphd::NodeName to_node = argv[optind + 1];
+graphd::Graph load_graph(std::string_view input, unsigned threads,
+                         graphd::RunStats *stats = nullptr) {
+    graphd::Graph g;
+    start_phase(stats, "parse");
+    graphd::ParseCounters counters =
+        graphd::input::parse_parallel(input, g, threads);
+    start_phase(stats, "freeze");
+    g.freeze();
+    if (stats != nullptr) {
+        stats->parse += counters;
+    }
+    return g;
+}
 
-    auto parser = graphd::input::Parser::of(in);
+/**
+ * Add the effort of the searches run with ws to what options count, if
+ * anything.
+ */
+void count(const graphd::SearchWorkspace &ws,
+           const graphd::BatchOptions &options) {
+    if (options.counters != nullptr) {
+        *options.counters += ws.counters();
+    }
+}
 
-    try {
-        graphd::Graph g;
-        std::unique_ptr<graphd::input::Expression> e{parser.parse()};
-        e->apply_to_graph(g);
+int run_single(const graphd::Graph &g, graphd::NodeName from_node,
+               graphd::NodeName to_node, const graphd::BatchOptions &options) {
+    graphd::SearchWorkspace ws;
+    graphd::Path p =
+        graphd::answer_query(g, {from_node, to_node}, ws, options);
+    count(ws, options);
+    std::cout << "total distance: " << p.total_distance << "\n";
+    std::cout << p.nodes[0];
+    for (size_t i = 1; i < p.nodes.size(); i++) {
+        std::cout << " -> " << p.nodes[i];
+    }
+    std::cout << "\n";
+
+    return EXIT_SUCCESS;
+}
+
+int run_alternatives(const graphd::Graph &g, graphd::NodeName from_node,
+                     graphd::NodeName to_node, std::size_t k,
+                     const graphd::BatchOptions &options) {
+    graphd::SearchWorkspace ws;
+    std::string out;
+    for (const graphd::Path &p :
+         g.k_shortest_paths(from_node, to_node, k, ws)) {
+        graphd::format_path(out, p);
+    }
+    count(ws, options);
+    std::cout << out;
+    return EXIT_SUCCESS;
+}
 
-        graphd::Path p = g.shortest_path(from_node, to_node);
-        std::cout << "total distance: " << p.total_distance << "\n";
-        std::cout << p.nodes[0];
-        for (size_t i = 1; i < p.nodes.size(); i++) {
-            std::cout << " -> " << p.nodes[i];
+int run_tree(const graphd::Graph &g, const graphd::NodeName &root,
+             double delta, const graphd::BatchOptions &options) {
+    graphd::ShortestPathTree tree;
+    if (options.threads > 1) {
+        // Delta-stepping keeps no search counters.
+        graphd::ThreadPool pool{options.threads};
+        tree = g.shortest_path_tree(g.id_of(root), pool, delta);
+    } else {
+        graphd::SearchWorkspace ws;
+        tree = g.shortest_path_tree(g.id_of(root), ws);
+        count(ws, options);
+    }
+    graphd::write_tree(g, tree, std::cout);
+    return EXIT_SUCCESS;
+}
+
+int run_batch(const graphd::Graph &g, std::string query_file,
+              const graphd::BatchOptions &options) {
+    if (query_file == "-") {
+        graphd::run_batch(g, std::cin, std::cout, options);
+    } else {
+        std::ifstream queries{query_file};
+        if (!queries) {
+            throw std::runtime_error{"cannot open query file: " + query_file};
         }
-        std::cout << "\n";
+        graphd::run_batch(g, queries, std::cout, options);
+    }
 
+    return EXIT_SUCCESS;
+}
+
+struct Settings {
+    std::string graph_file;
+    std::string query_file;
+    std::string snapshot_file;
+    std::string tree_root;
+    std::string sources_file;
+    std::string targets_file;
+    std::string matrix_file;
+    std::string socket_file;
+    std::string heuristic;
+    // Where to report stats, "-" for stderr, empty for nowhere
+    std::string stats_file;
+    // What is reported there, if anything
+    graphd::RunStats *stats = nullptr;
+    unsigned landmark_count = graphd::LandmarkHeuristic::default_count;
+    // Number of paths to find for a single query, 0 for just the shortest
+    std::size_t paths = 0;
+    // Number of query results to cache, 0 for none
+    std::size_t cache_size = 0;
+    // Bucket width of parallel -s searches, 0 for the default
+    double delta = 0;
+    bool use_hierarchy = false;
+    graphd::BatchOptions options;
+};
+
+std::vector<graphd::NodeName> read_nodes(const std::string &path) {
+    std::ifstream in{path};
+    if (!in) {
+        throw std::runtime_error{"cannot open node list: " + path};
+    }
+    return graphd::read_nodes(in);
+}
+
+int run_matrix(const graphd::Graph &g, const Settings &settings,
+               const graphd::BatchOptions &options) {
+    std::vector<graphd::NodeName> sources = read_nodes(settings.sources_file);
+    std::vector<graphd::NodeName> targets =
+        settings.targets_file.empty() ? sources
+                                      : read_nodes(settings.targets_file);
+    graphd::DistanceMatrix matrix =
+        graphd::answer_matrix(g, sources, targets, options);
+
+    if (settings.matrix_file.empty()) {
+        matrix.write_text(std::cout);
         return EXIT_SUCCESS;
-    } catch (const std::exception &e) {
-        std::cerr << "error: " << e.what() << "\n";
-        return EXIT_FAILURE;
     }
+    std::ofstream out{settings.matrix_file, std::ios::binary};
+    matrix.write_binary(out);
+    out.close();
+    if (!out) {
+        throw std::runtime_error{"cannot write matrix file: " +
+                                 settings.matrix_file};
+    }
+    return EXIT_SUCCESS;
 }
 
-int main(int argc, char **argv) {
-    if (int opt = getopt(argc, argv, "f:"); opt == 'f') {
-        std::fstream f{optarg};
-        return run(f, argc, argv);
-        f.close();
+void write_snapshot(const std::string &path, const graphd::Graph &g,
+                    const graphd::ContractionHierarchy *ch,
+                    const graphd::LandmarkHeuristic *alt) {
+    std::ofstream out{path, std::ios::binary};
+    if (!out) {
+        throw std::runtime_error{"cannot open snapshot file: " + path};
+    }
+    graphd::Snapshot::write(out, g, ch, alt);
+    out.close();
+    if (!out) {
+        throw std::runtime_error{"cannot write snapshot file: " + path};
+    }
+}
+
+/**
+ * What queries against a graph need besides the graph, if not loaded along
+ * with it.
+ */
+struct Preprocessing {
+    std::unique_ptr<graphd::Heuristic> heuristic;
+    std::unique_ptr<graphd::ContractionHierarchy> hierarchy;
+    std::unique_ptr<graphd::QueryCache> cache;
+};
+
+/**
+ * Options for answering queries against g as the settings ask. ch and alt
+ * are a hierarchy and landmarks loaded along with the graph, if any,
+ * anything else needed is built into pre.
+ */
+graphd::BatchOptions prepare(const graphd::Graph &g,
+                             const graphd::ContractionHierarchy *ch,
+                             const graphd::LandmarkHeuristic *alt,
+                             const Settings &settings, Preprocessing &pre) {
+    graphd::BatchOptions options = settings.options;
+
+    if (settings.heuristic == "landmarks") {
+        if (alt == nullptr) {
+            auto landmarks = std::make_unique<graphd::LandmarkHeuristic>(
+                g, settings.landmark_count);
+            alt = landmarks.get();
+            pre.heuristic = std::move(landmarks);
+        }
+        options.heuristic = alt;
+    } else if (!settings.heuristic.empty()) {
+        pre.heuristic = graphd::make_heuristic(settings.heuristic, g);
+        options.heuristic = pre.heuristic.get();
+    }
+
+    if (settings.use_hierarchy) {
+        if (ch == nullptr) {
+            pre.hierarchy = std::make_unique<graphd::ContractionHierarchy>(g);
+            ch = pre.hierarchy.get();
+        }
+        options.hierarchy = ch;
+    }
+
+    if (settings.cache_size > 0) {
+        pre.cache =
+            std::make_unique<graphd::QueryCache>(g, settings.cache_size);
+        options.cache = pre.cache.get();
+    }
+    return options;
+}
+
+/**
+ * A graph loaded from the graph file, and what queries against it need.
+ */
+struct Loaded {
+    std::optional<graphd::Snapshot> snapshot;
+    graphd::Graph graph;
+    Preprocessing preprocessing;
+};
+
+graphd::ServedGraph load_served(const Settings &settings) {
+    auto loaded = std::make_shared<Loaded>();
+    const graphd::Graph *g = &loaded->graph;
+    const graphd::ContractionHierarchy *ch = nullptr;
+    const graphd::LandmarkHeuristic *alt = nullptr;
+    if (graphd::Snapshot::is_snapshot(settings.graph_file)) {
+        loaded->snapshot.emplace(graphd::Snapshot::load(settings.graph_file));
+        g = &loaded->snapshot->graph();
+        ch = loaded->snapshot->hierarchy();
+        alt = loaded->snapshot->landmarks();
     } else {
-        return run(std::cin, argc, argv);
+        graphd::MappedFile file{settings.graph_file};
+        loaded->graph = load_graph(std::string_view{file.data(), file.size()},
+                                   settings.options.threads);
+    }
+    graphd::BatchOptions options =
+        prepare(*g, ch, alt, settings, loaded->preprocessing);
+    return graphd::ServedGraph{g, options, loaded};
+}
+
+graphd::Server *running_server = nullptr;
+
+void stop_server(int) {
+    if (running_server != nullptr) {
+        running_server->stop();
+    }
+}
+
+void reload_server(int) {
+    if (running_server != nullptr) {
+        running_server->reload();
+    }
+}
+
+/**
+ * Serve graph until terminated, reloading the graph file on SIGHUP.
+ */
+int serve(graphd::ServedGraph graph, const Settings &settings) {
+    std::function<graphd::ServedGraph()> reload;
+    // A graph read from stdin cannot be read again.
+    if (!settings.graph_file.empty()) {
+        reload = [&settings] {
+            try {
+                graphd::ServedGraph graph = load_served(settings);
+                std::cerr << "reloaded " << settings.graph_file << "\n";
+                return graph;
+            } catch (const std::exception &e) {
+                std::cerr << "error: cannot reload " << settings.graph_file
+                          << ": " << e.what() << "\n";
+                throw;
+            }
+        };
+    }
+
+    graphd::Server server{std::move(graph), settings.socket_file, reload};
+    running_server = &server;
+    std::signal(SIGINT, stop_server);
+    std::signal(SIGTERM, stop_server);
+    std::signal(SIGHUP, reload_server);
+    server.run();
+    running_server = nullptr;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Answer the queries given on the command line. ch and alt are a hierarchy
+ * and landmarks loaded along with the graph, if any.
+ */
+int run(const graphd::Graph &g, const graphd::ContractionHierarchy *ch,
+        const graphd::LandmarkHeuristic *alt, const Settings &settings,
+        int argc, char **argv) {
+    if (settings.stats != nullptr) {
+        settings.stats->nodes = g.node_count();
+        settings.stats->edges = g.edge_count();
+    }
+    start_phase(settings.stats, "preprocess");
+    Preprocessing pre;
+    graphd::BatchOptions options = prepare(g, ch, alt, settings, pre);
+
+    if (!settings.snapshot_file.empty()) {
+        start_phase(settings.stats, "write snapshot");
+        const graphd::LandmarkHeuristic *landmarks = nullptr;
+        if (settings.heuristic == "landmarks") {
+            landmarks = static_cast<const graphd::LandmarkHeuristic *>(
+                options.heuristic);
+        }
+        write_snapshot(settings.snapshot_file, g, options.hierarchy,
+                       landmarks);
+        if (optind == argc && settings.query_file.empty() &&
+            settings.tree_root.empty() && settings.sources_file.empty() &&
+            settings.socket_file.empty()) {
+            return EXIT_SUCCESS;
+        }
+    }
+
+    start_phase(settings.stats, "query");
+    if (!settings.socket_file.empty()) {
+        return serve(graphd::ServedGraph{&g, options, nullptr}, settings);
+    }
+    if (!settings.query_file.empty()) {
+        return run_batch(g, settings.query_file, options);
+    }
+    if (!settings.sources_file.empty()) {
+        return run_matrix(g, settings, options);
+    }
+    if (!settings.tree_root.empty()) {
+        return run_tree(g, settings.tree_root, settings.delta, options);
+    }
+    if (settings.paths > 0) {
+        return run_alternatives(g, argv[optind], argv[optind + 1],
+                                settings.paths, options);
+    }
+    return run_single(g, argv[optind], argv[optind + 1], options);
+}
+
+int run(std::string_view input, const Settings &settings, int argc,
+        char **argv) {
+    graphd::Graph g =
+        load_graph(input, settings.options.threads, settings.stats);
+    return run(g, nullptr, nullptr, settings, argc, argv);
+}
+
+/**
+ * Load the graph and answer the queries the settings ask for.
+ */
+int run(const Settings &settings, int argc, char **argv) {
+    start_phase(settings.stats, "read");
+    if (settings.graph_file.empty()) {
+        if (settings.query_file == "-") {
+            std::cerr << "error: graph and queries cannot both be read "
+                         "from stdin\n";
+            return EXIT_FAILURE;
+        }
+        std::ostringstream input;
+        input << std::cin.rdbuf();
+        return run(input.str(), settings, argc, argv);
+    }
+
+    if (graphd::Snapshot::is_snapshot(settings.graph_file)) {
+        auto snapshot = graphd::Snapshot::load(settings.graph_file);
+        return run(snapshot.graph(), snapshot.hierarchy(),
+                   snapshot.landmarks(), settings, argc, argv);
+    }
+
+    // Tokens refer to the mapped file, no need to copy it.
+    graphd::MappedFile file{settings.graph_file};
+    return run(std::string_view{file.data(), file.size()}, settings, argc,
+               argv);
+}
+
+void write_stats(const graphd::RunStats &stats, const std::string &path) {
+    if (path == "-") {
+        stats.write_json(std::cerr);
+        return;
+    }
+    std::ofstream out{path};
+    stats.write_json(out);
+    out.close();
+    if (!out) {
+        throw std::runtime_error{"cannot write stats file: " + path};
+    }
+}
+
+/**
+ * The positive number that makes up all of arg. Throws an error naming what
+ * the number was meant to be otherwise.
+ */
+int parse_positive(const std::string &arg, const std::string &what) {
+    std::size_t end = 0;
+    int n = 0;
+    try {
+        n = std::stoi(arg, &end);
+    } catch (const std::logic_error &) {
+        // Not a number, or out of range
+        end = 0;
+    }
+    if (end == 0 || end != arg.size() || n <= 0) {
+        throw std::runtime_error{"invalid " + what + ": " + arg};
+    }
+    return n;
+}
+
+/**
+ * The bucket width given with --delta, which must be positive and finite.
+ */
+double parse_delta(const std::string &arg) {
+    std::size_t end = 0;
+    double d = 0;
+    try {
+        d = std::stod(arg, &end);
+    } catch (const std::logic_error &) {
+        end = 0;
+    }
+    if (end == 0 || end != arg.size() || !(d > 0 && d < graphd::infinity)) {
+        throw std::runtime_error{"invalid delta: " + arg};
+    }
+    return d;
+}
+
+int main(int argc, char **argv) {
+    Settings settings;
+    graphd::BatchOptions &options = settings.options;
+
+    // Long options have no short form, their values start past any char.
+    enum { SERVE = 256, STATS, DELTA };
+    const option long_options[] = {
+        {"serve", required_argument, nullptr, SERVE},
+        {"stats", optional_argument, nullptr, STATS},
+        {"delta", required_argument, nullptr, DELTA},
+        {nullptr, 0, nullptr, 0},
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "a:c:f:H:j:k:L:m:o:q:s:t:w:",
+                              long_options, nullptr)) != -1) {
+        try {
+            switch (opt) {
+            case 'a':
+                // Hierarchies need preprocessing, they are not a Graph
+                // algorithm.
+                settings.use_hierarchy = std::string{optarg} == "ch";
+                if (std::string{optarg} == "alt") {
+                    options.algorithm = graphd::Algorithm::ASTAR;
+                    settings.heuristic = "landmarks";
+                } else if (!settings.use_hierarchy) {
+                    options.algorithm = graphd::parse_algorithm(optarg);
+                }
+                break;
+            case 'c':
+                settings.cache_size = parse_positive(optarg, "cache size");
+                break;
+            case 'f':
+                settings.graph_file = optarg;
+                break;
+            case 'H':
+                settings.heuristic = optarg;
+                break;
+            case 'j':
+                options.threads = parse_positive(optarg, "number of threads");
+                break;
+            case 'k':
+                settings.paths = parse_positive(optarg, "number of paths");
+                break;
+            case 'L':
+                settings.landmark_count =
+                    parse_positive(optarg, "number of landmarks");
+                break;
+            case 'm':
+                settings.sources_file = optarg;
+                break;
+            case 'o':
+                settings.matrix_file = optarg;
+                break;
+            case 'q':
+                settings.query_file = optarg;
+                break;
+            case 's':
+                settings.tree_root = optarg;
+                break;
+            case 't':
+                settings.targets_file = optarg;
+                break;
+            case 'w':
+                settings.snapshot_file = optarg;
+                break;
+            case SERVE:
+                settings.socket_file = optarg;
+                break;
+            case DELTA:
+                settings.delta = parse_delta(optarg);
+                break;
+            case STATS:
+                settings.stats_file = optarg != nullptr ? optarg : "-";
+                break;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        } catch (const std::exception &e) {
+            std::cerr << "error: " << e.what() << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!settings.heuristic.empty() &&
+        options.algorithm != graphd::Algorithm::ASTAR) {
+        std::cerr << "error: -H requires -a astar\n";
+        return EXIT_FAILURE;
+    }
+    if (settings.delta > 0 &&
+        (settings.tree_root.empty() || options.threads < 2)) {
+        std::cerr << "error: --delta requires -s and -j N\n";
+        return EXIT_FAILURE;
+    }
+
+    // Node names are only optional when just writing a snapshot.
+    int args = argc - optind;
+    bool just_write = !settings.snapshot_file.empty() && args == 0;
+    int modes = !settings.query_file.empty() + !settings.tree_root.empty() +
+                !settings.sources_file.empty() + !settings.socket_file.empty();
+    bool matrix_options =
+        !settings.targets_file.empty() || !settings.matrix_file.empty();
+    if (args != (modes == 0 && !just_write ? 2 : 0) || modes > 1 ||
+        (settings.paths > 0 && (modes > 0 || just_write)) ||
+        (matrix_options && settings.sources_file.empty())) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Results may be many; don't pay for synchronization with stdio.
+    std::ios::sync_with_stdio(false);
+
+    graphd::RunStats stats;
+    if (!settings.stats_file.empty()) {
+        settings.stats = &stats;
+        options.counters = &stats.search;
+    }
+
+    try {
+        int status = run(settings, argc, argv);
+        if (settings.stats != nullptr) {
+            stats.end_phase();
+            write_stats(stats, settings.stats_file);
+        }
+        return status;
+    } catch (const std::exception &e) {
+        std::cerr << "error: " << e.what() << "\n";
+        return EXIT_FAILURE;
     }
 }
@@ -0,0 +1,142 @@
+#include <graphd/cache.hpp>
+#include <graphd/workspace.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace graphd {
+
+/**
+ * Both node IDs in one integer, the lower one in the upper half. Queries in
+ * either direction share a key, as do both directions of an edge.
+ */
+static std::uint64_t key_of(NodeId n1, NodeId n2) {
+    return static_cast<std::uint64_t>(std::min(n1, n2)) << 32 |
+           std::max(n1, n2);
+}
+
+QueryCache::QueryCache(const Graph &g, std::size_t capacity)
+    : g{g}, capacity{capacity} {}
+
+std::optional<Path> QueryCache::find(const NodeName &from,
+                                     const NodeName &to) {
+    NodeId start = g.id_of(from);
+    NodeId end = g.id_of(to);
+    std::vector<NodeId> nodes;
+    double distance;
+    {
+        std::lock_guard lock{mutex};
+        auto it = entries.find(key_of(start, end));
+        if (it == entries.end()) {
+            counts.misses++;
+            return std::nullopt;
+        }
+        counts.hits++;
+        order.splice(order.end(), order, it->second.age);
+        nodes = it->second.nodes;
+        distance = it->second.distance;
+    }
+
+    // Names are only looked up outside the lock.
+    if (start > end) {
+        std::reverse(nodes.begin(), nodes.end());
+    }
+    Path p{distance, {}};
+    p.nodes.reserve(nodes.size());
+    for (NodeId n : nodes) {
+        p.nodes.emplace_back(g.name_of(n));
+    }
+    return p;
+}
+
+void QueryCache::insert(const NodeName &from, const NodeName &to,
+                        const Path &p) {
+    if (capacity == 0) {
+        return;
+    }
+    NodeId start = g.id_of(from);
+    NodeId end = g.id_of(to);
+    Entry entry{p.total_distance, {}, {}};
+    entry.nodes.reserve(p.nodes.size());
+    for (const NodeName &n : p.nodes) {
+        entry.nodes.push_back(g.id_of(n));
+    }
+    if (start > end) {
+        std::reverse(entry.nodes.begin(), entry.nodes.end());
+    }
+
+    std::uint64_t key = key_of(start, end);
+    std::lock_guard lock{mutex};
+    erase(key);
+    while (entries.size() >= capacity) {
+        erase(order.front());
+    }
+    for (std::size_t i = 1; i < entry.nodes.size(); i++) {
+        users[key_of(entry.nodes[i - 1], entry.nodes[i])].insert(key);
+    }
+    entry.age = order.insert(order.end(), key);
+    entries.emplace(key, std::move(entry));
+}
+
+void QueryCache::edge_changed(NodeName n1, NodeName n2, double old_weight,
+                              double new_weight) {
+    edge_changed(g.id_of(n1), g.id_of(n2), old_weight, new_weight);
+}
+
+void QueryCache::edge_changed(NodeId n1, NodeId n2, double old_weight,
+                              double new_weight) {
+    std::lock_guard lock{mutex};
+    std::vector<std::uint64_t> stale;
+    if (auto it = users.find(key_of(n1, n2)); it != users.end()) {
+        stale.assign(it->second.begin(), it->second.end());
+    }
+    if (new_weight < old_weight) {
+        for (const auto &[key, entry] : entries) {
+            if (entry.distance > new_weight) {
+                stale.push_back(key);
+            }
+        }
+    }
+    for (std::uint64_t key : stale) {
+        erase(key);
+    }
+}
+
+void QueryCache::erase(std::uint64_t key) {
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return;
+    }
+    const std::vector<NodeId> &nodes = it->second.nodes;
+    for (std::size_t i = 1; i < nodes.size(); i++) {
+        // An edge may occur twice on a path, and be gone the second time.
+        if (auto u = users.find(key_of(nodes[i - 1], nodes[i]));
+            u != users.end()) {
+            u->second.erase(key);
+            if (u->second.empty()) {
+                users.erase(u);
+            }
+        }
+    }
+    order.erase(it->second.age);
+    entries.erase(it);
+}
+
+std::size_t QueryCache::size() const {
+    std::lock_guard lock{mutex};
+    return entries.size();
+}
+
+QueryCache::Counters QueryCache::counters() const {
+    std::lock_guard lock{mutex};
+    return counts;
+}
+
+void QueryCache::clear() {
+    std::lock_guard lock{mutex};
+    entries.clear();
+    order.clear();
+    users.clear();
+}
+
+} // namespace graphd
@@ -0,0 +1,480 @@
+#include <graphd/ch.hpp>
+#include <graphd/matrix.hpp>
+#include <graphd/pool.hpp>
+#include <graphd/workspace.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+namespace graphd {
+
+// Witness searches give up after settling this many nodes. Giving up early
+// only costs superfluous shortcuts, never correctness.
+static constexpr std::size_t witness_settle_limit = 100;
+// Contraction stops once the next node to be contracted has more neighbors
+// than this. The remaining nodes form an uncontracted core at the top of the
+// hierarchy. On graphs without a road-like structure, contraction would
+// otherwise make the remaining graph ever denser, at quadratic cost.
+static constexpr std::size_t core_degree = 64;
+
+/**
+ * Contraction state: the remaining graph as mutable adjacency lists.
+ */
+class ContractionHierarchy::Builder {
+  public:
+    Builder(const Graph &g);
+    void build(ContractionHierarchy &ch);
+
+  private:
+    struct Arc {
+        NodeId target;
+        double weight;
+        NodeId middle;
+    };
+    struct Shortcut {
+        NodeId from;
+        NodeId to;
+        double weight;
+    };
+
+    void find_shortcuts(NodeId n, std::vector<Shortcut> &out);
+    int priority(NodeId n);
+    void contract(NodeId n);
+    void add_arc(NodeId from, NodeId to, double weight, NodeId middle);
+    void remove_arc(NodeId from, NodeId to);
+
+    std::vector<std::vector<Arc>> adjacency;
+    std::vector<std::vector<Arc>> upward;
+    std::vector<unsigned> deleted_neighbors;
+    std::vector<unsigned> level;
+    std::vector<bool> contracted;
+    // Marks the nodes a witness search is looking for
+    std::vector<bool> is_target;
+    std::vector<Shortcut> shortcuts;
+    SearchState witness;
+};
+
+ContractionHierarchy::Builder::Builder(const Graph &g)
+    : adjacency(g.node_count()), upward(g.node_count()),
+      deleted_neighbors(g.node_count(), 0), level(g.node_count(), 0),
+      contracted(g.node_count(), false), is_target(g.node_count(), false) {
+    for (NodeId n = 0; n < g.node_count(); n++) {
+        for (auto e = g.edges_begin(n); e < g.edges_end(n); e++) {
+            adjacency[n].push_back(
+                Arc{g.edge_target(e), g.edge_weight(e), no_node});
+        }
+    }
+}
+
+void ContractionHierarchy::Builder::find_shortcuts(NodeId n,
+                                                   std::vector<Shortcut> &out) {
+    out.clear();
+    const auto &arcs = adjacency[n];
+
+    // Edges are undirected, so each pair of neighbors is only looked at once.
+    for (std::size_t i = 0; i + 1 < arcs.size(); i++) {
+        NodeId source = arcs[i].target;
+        double max_via = 0.0;
+        for (std::size_t j = i + 1; j < arcs.size(); j++) {
+            max_via = std::max(max_via, arcs[i].weight + arcs[j].weight);
+        }
+
+        // Is there a path from source to the other neighbors avoiding n that
+        // is no longer than the path via n?
+        std::size_t unsettled_targets = arcs.size() - i - 1;
+        for (std::size_t j = i + 1; j < arcs.size(); j++) {
+            is_target[arcs[j].target] = true;
+        }
+        witness.reset(adjacency.size());
+        witness.relax(source, 0.0, no_node);
+        std::size_t settled = 0;
+        while (unsettled_targets > 0 && witness.has_next() &&
+               witness.next_priority() <= max_via &&
+               settled++ < witness_settle_limit) {
+            NodeId node = witness.pop();
+            if (is_target[node]) {
+                unsettled_targets--;
+            }
+            double node_dist = witness.distance(node);
+            for (const Arc &a : adjacency[node]) {
+                if (a.target != n) {
+                    witness.relax(a.target, node_dist + a.weight, node);
+                }
+            }
+        }
+
+        for (std::size_t j = i + 1; j < arcs.size(); j++) {
+            is_target[arcs[j].target] = false;
+            double via = arcs[i].weight + arcs[j].weight;
+            if (witness.distance(arcs[j].target) > via) {
+                out.push_back(Shortcut{source, arcs[j].target, via});
+            }
+        }
+    }
+}
+
+int ContractionHierarchy::Builder::priority(NodeId n) {
+    find_shortcuts(n, shortcuts);
+    int edge_difference = int(shortcuts.size()) - int(adjacency[n].size());
+    // Prefer nodes whose contraction shrinks the graph. Spread contraction
+    // evenly and keep the hierarchy shallow, which keeps query searches small.
+    return 2 * edge_difference + int(deleted_neighbors[n]) + int(level[n]);
+}
+
+void ContractionHierarchy::Builder::add_arc(NodeId from, NodeId to,
+                                            double weight, NodeId middle) {
+    for (Arc &a : adjacency[from]) {
+        if (a.target == to) {
+            if (weight < a.weight) {
+                a.weight = weight;
+                a.middle = middle;
+            }
+            return;
+        }
+    }
+    adjacency[from].push_back(Arc{to, weight, middle});
+}
+
+void ContractionHierarchy::Builder::remove_arc(NodeId from, NodeId to) {
+    auto &arcs = adjacency[from];
+    arcs.erase(std::remove_if(arcs.begin(), arcs.end(),
+                              [to](const Arc &a) { return a.target == to; }),
+               arcs.end());
+}
+
+void ContractionHierarchy::Builder::contract(NodeId n) {
+    // The shortcuts were found when computing the node's priority.
+    for (const Shortcut &s : shortcuts) {
+        add_arc(s.from, s.to, s.weight, n);
+        add_arc(s.to, s.from, s.weight, n);
+    }
+
+    for (const Arc &a : adjacency[n]) {
+        remove_arc(a.target, n);
+        deleted_neighbors[a.target]++;
+        level[a.target] = std::max(level[a.target], level[n] + 1);
+    }
+
+    // All remaining neighbors will be contracted later, i.e. rank higher.
+    upward[n] = std::move(adjacency[n]);
+    std::vector<Arc>{}.swap(adjacency[n]);
+    contracted[n] = true;
+}
+
+void ContractionHierarchy::Builder::build(ContractionHierarchy &ch) {
+    NodeId count = adjacency.size();
+    using Entry = std::pair<int, NodeId>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    for (NodeId n = 0; n < count; n++) {
+        // Don't bother with nodes that are bound to end up in the core.
+        bool hub = adjacency[n].size() > core_degree;
+        queue.emplace(hub ? std::numeric_limits<int>::max() : priority(n), n);
+    }
+
+    std::vector<NodeId> rank(count, 0);
+    NodeId next_rank = 0;
+    while (!queue.empty()) {
+        NodeId n = queue.top().second;
+        queue.pop();
+        if (contracted[n]) {
+            continue;
+        }
+        if (adjacency[n].size() > core_degree) {
+            break;
+        }
+
+        // Priorities change as neighbors get contracted. Only update them
+        // lazily, when a node is about to be contracted.
+        int current = priority(n);
+        if (!queue.empty() && current > queue.top().first) {
+            queue.emplace(current, n);
+            continue;
+        }
+
+        // shortcuts still holds those found by priority(n)
+        contract(n);
+        rank[n] = next_rank++;
+    }
+
+    // Core nodes rank above all others. Edges between them are kept in both
+    // directions, so that queries search the core like a plain graph.
+    for (NodeId n = 0; n < count; n++) {
+        if (!contracted[n]) {
+            upward[n] = std::move(adjacency[n]);
+            rank[n] = next_rank++;
+        }
+    }
+
+    ch.rank = std::move(rank);
+
+    std::vector<std::uint64_t> offsets(count + 1, 0);
+    for (NodeId n = 0; n < count; n++) {
+        offsets[n + 1] = offsets[n] + upward[n].size();
+    }
+    std::vector<NodeId> targets;
+    std::vector<double> weights;
+    std::vector<NodeId> middle;
+    targets.reserve(offsets.back());
+    weights.reserve(offsets.back());
+    middle.reserve(offsets.back());
+    for (NodeId n = 0; n < count; n++) {
+        for (const Arc &a : upward[n]) {
+            targets.push_back(a.target);
+            weights.push_back(a.weight);
+            middle.push_back(a.middle);
+        }
+    }
+    ch.offsets = std::move(offsets);
+    ch.targets = std::move(targets);
+    ch.weights = std::move(weights);
+    ch.middle = std::move(middle);
+}
+
+ContractionHierarchy::ContractionHierarchy(const Graph &g)
+    : g{g}, revision{g.revision()} {
+    if (!g.is_frozen()) {
+        throw std::logic_error{"graph must be frozen before preprocessing"};
+    }
+    Builder{g}.build(*this);
+}
+
+ContractionHierarchy::ContractionHierarchy(const Graph &g,
+                                           std::shared_ptr<const void> storage)
+    : g{g}, revision{g.revision()}, storage{std::move(storage)} {
+}
+
+void ContractionHierarchy::check_current() const {
+    if (g.revision() != revision) {
+        throw std::logic_error{"contraction hierarchy is out of date"};
+    }
+}
+
+const Graph &ContractionHierarchy::graph() const {
+    return g;
+}
+
+std::size_t ContractionHierarchy::shortcut_count() const {
+    std::size_t count = 0;
+    for (NodeId m : middle) {
+        if (m != no_node) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool ContractionHierarchy::stalled(NodeId n, const SearchState &state) const {
+    // Stall-on-demand
+    for (auto e = offsets[n]; e < offsets[n + 1]; e++) {
+        if (state.distance(targets[e]) + weights[e] < state.distance(n)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Visit>
+void ContractionHierarchy::search_upwards(NodeId n, SearchState &state,
+                                          Visit visit) const {
+    state.reset(g.node_count());
+    state.relax(n, 0.0, no_node);
+    while (state.has_next()) {
+        NodeId node = state.pop();
+        if (stalled(node, state)) {
+            continue;
+        }
+        double node_dist = state.distance(node);
+        visit(node, node_dist);
+        for (auto e = offsets[node]; e < offsets[node + 1]; e++) {
+            state.relax(targets[e], node_dist + weights[e], node);
+        }
+    }
+}
+
+std::uint64_t ContractionHierarchy::find_edge(NodeId n1, NodeId n2) const {
+    // Edges are only stored at the lower-ranked endpoint.
+    if (rank[n1] > rank[n2]) {
+        std::swap(n1, n2);
+    }
+    for (auto e = offsets[n1]; e < offsets[n1 + 1]; e++) {
+        if (targets[e] == n2) {
+            return e;
+        }
+    }
+    throw std::logic_error{"missing edge in contraction hierarchy"};
+}
+
+void ContractionHierarchy::unpack(NodeId from, NodeId to,
+                                  std::vector<NodeId> &hops) const {
+    // Appends the nodes after from, up to and including to. Shortcuts may
+    // nest deeply, so unpack iteratively.
+    std::vector<std::pair<NodeId, NodeId>> pending{{from, to}};
+    while (!pending.empty()) {
+        auto [n1, n2] = pending.back();
+        pending.pop_back();
+
+        NodeId m = middle[find_edge(n1, n2)];
+        if (m == no_node) {
+            hops.push_back(n2);
+        } else {
+            pending.emplace_back(m, n2);
+            pending.emplace_back(n1, m);
+        }
+    }
+}
+
+Path ContractionHierarchy::shortest_path(NodeName from, NodeName to,
+                                         SearchWorkspace &ws) const {
+    check_current();
+    NodeId start = g.id_of(from);
+    NodeId end = g.id_of(to);
+
+    SearchState &fwd = ws.forward;
+    SearchState &bwd = ws.backward;
+    fwd.reset(g.node_count());
+    bwd.reset(g.node_count());
+    fwd.relax(start, 0.0, no_node);
+    bwd.relax(end, 0.0, no_node);
+
+    double best = start == end ? 0.0 : infinity;
+    NodeId meeting = start;
+
+    // Both searches only move upwards, so neither can stop as soon as they
+    // meet. Each stops once its frontier can't improve on the best path.
+    while (true) {
+        bool fwd_open = fwd.has_next() && fwd.next_priority() < best;
+        bool bwd_open = bwd.has_next() && bwd.next_priority() < best;
+        if (!fwd_open && !bwd_open) {
+            break;
+        }
+
+        bool forward = fwd_open && (!bwd_open || fwd.next_priority() <=
+                                                     bwd.next_priority());
+        SearchState &self = forward ? fwd : bwd;
+        const SearchState &other = forward ? bwd : fwd;
+
+        NodeId node = self.pop();
+        double node_dist = self.distance(node);
+
+        if (stalled(node, self)) {
+            continue;
+        }
+
+        for (auto e = offsets[node]; e < offsets[node + 1]; e++) {
+            NodeId neighbor = targets[e];
+            self.relax(neighbor, node_dist + weights[e], node);
+
+            double through = self.distance(neighbor) + other.distance(neighbor);
+            if (through < best) {
+                best = through;
+                meeting = neighbor;
+            }
+        }
+    }
+
+    if (best == infinity) {
+        throw std::runtime_error{"nodes not connected: " + from + ", " + to};
+    }
+
+    // Upward paths from both ends to the meeting point
+    std::vector<NodeId> up;
+    for (NodeId n = meeting; n != no_node; n = fwd.parent(n)) {
+        up.push_back(n);
+    }
+    std::reverse(up.begin(), up.end());
+    for (NodeId n = bwd.parent(meeting); n != no_node; n = bwd.parent(n)) {
+        up.push_back(n);
+    }
+
+    std::vector<NodeId> hops{start};
+    for (std::size_t i = 1; i < up.size(); i++) {
+        unpack(up[i - 1], up[i], hops);
+    }
+
+    std::vector<NodeName> names;
+    names.reserve(hops.size());
+    for (NodeId n : hops) {
+        names.emplace_back(g.name_of(n));
+    }
+    return Path{best, names};
+}
+
+DistanceMatrix
+ContractionHierarchy::distance_matrix(const std::vector<NodeName> &sources,
+                                      const std::vector<NodeName> &targets,
+                                      unsigned threads) const {
+    check_current();
+    std::vector<NodeId> from;
+    for (const NodeName &n : sources) {
+        from.push_back(g.id_of(n));
+    }
+    std::vector<NodeId> to;
+    for (const NodeName &n : targets) {
+        to.push_back(g.id_of(n));
+    }
+
+    struct Entry {
+        NodeId node;
+        std::uint32_t column;
+        double distance;
+    };
+    ThreadPool pool{threads};
+    std::vector<SearchWorkspace> workspaces(pool.size());
+    std::vector<std::vector<Entry>> entries(pool.size());
+    for (std::size_t column = 0; column < to.size(); column++) {
+        pool.submit([&, column](unsigned worker) {
+            search_upwards(to[column], workspaces[worker].backward,
+                           [&](NodeId node, double dist) {
+                               entries[worker].push_back(
+                                   Entry{node, std::uint32_t(column), dist});
+                           });
+        });
+    }
+    pool.wait();
+
+    // Buckets in CSR form: the entries left at node n are
+    // buckets[bucket_offsets[n]] to buckets[bucket_offsets[n + 1]].
+    std::vector<std::uint64_t> bucket_offsets(g.node_count() + 1, 0);
+    for (const auto &found : entries) {
+        for (const Entry &entry : found) {
+            bucket_offsets[entry.node + 1]++;
+        }
+    }
+    std::partial_sum(bucket_offsets.begin(), bucket_offsets.end(),
+                     bucket_offsets.begin());
+    std::vector<std::pair<std::uint32_t, double>> buckets(
+        bucket_offsets.back());
+    std::vector<std::uint64_t> fill(bucket_offsets.begin(),
+                                    bucket_offsets.end() - 1);
+    for (auto &found : entries) {
+        for (const Entry &entry : found) {
+            buckets[fill[entry.node]++] = {entry.column, entry.distance};
+        }
+        found = {};
+    }
+
+    DistanceMatrix matrix{from.size(), to.size()};
+    for (std::size_t row = 0; row < from.size(); row++) {
+        pool.submit([&, row](unsigned worker) {
+            search_upwards(
+                from[row], workspaces[worker].forward,
+                [&](NodeId node, double dist) {
+                    for (auto b = bucket_offsets[node];
+                         b < bucket_offsets[node + 1]; b++) {
+                        auto [column, rest] = buckets[b];
+                        double &best = matrix.at(row, column);
+                        best = std::min(best, dist + rest);
+                    }
+                });
+        });
+    }
+    pool.wait();
+    return matrix;
+}
+
+} // namespace graphd
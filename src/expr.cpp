@@ -1,24 +1,11 @@
 #include <graphd/input/parser/expr.hpp>
 
+#include <stdexcept>
 #include <string>
 #include <utility>
 
 namespace graphd::input::expr {
 
-TokenExpr::TokenExpr(Token t) : token{t} {}
-
-ExprType TokenExpr::type() {
-    return ExprType::TOKEN_EXPR;
-}
-
-void TokenExpr::apply_to_graph(Graph &) {
-    throw std::logic_error{"attempting to apply token expression to graph"};
-}
-
-bool TokenExpr::is_instance(Expression *e) {
-    return e->type() == ExprType::TOKEN_EXPR;
-}
-
 bool Attribute::is_instance(Expression *e) {
     return e->type() == ExprType::ATTRIBUTE;
 }
@@ -32,7 +19,7 @@ void Attribute::apply_to_graph(Graph &) {
         "'Attribute' object cannot be applied to graph directly"};
 }
 
-Attribute::Attribute(std::string attr_name, std::string attr_value)
+Attribute::Attribute(std::string_view attr_name, std::string_view attr_value)
     : name{attr_name}, value{attr_value} {}
 
 bool AttributeList::is_instance(Expression *e) {
@@ -48,16 +35,10 @@ void AttributeList::apply_to_graph(Graph &) {
         "'AttributeList' object cannot be applied to graph directly"};
 }
 
-AttributeList::AttributeList(std::vector<Attribute *> &&attrs)
-    : attributes{attrs} {}
+AttributeList::AttributeList(std::pmr::vector<Attribute *> &&attrs)
+    : attributes{std::move(attrs)} {}
 
-AttributeList::~AttributeList() {
-    for (auto attr : attributes) {
-        delete attr;
-    }
-}
-
-std::optional<std::string> AttributeList::get_attr(std::string name) {
+std::optional<std::string_view> AttributeList::get_attr(std::string_view name) {
     for (auto attr : attributes) {
         if (attr->name == name) {
             return attr->value;
@@ -79,18 +60,14 @@ void AList::apply_to_graph(Graph &) {
         "'AList' object cannot be applied to graph directly"};
 }
 
-AList::~AList() {
-    for (auto attr : attributes) {
-        delete attr;
-    }
-}
+AList::AList(std::pmr::memory_resource *memory) : attributes{memory} {}
 
 void AList::add_attribute(Attribute *attr) {
     attributes.push_back(attr);
 }
 
-AttributeList *AList::as_attr_list() {
-    auto attr_list = new AttributeList{std::move(attributes)};
+AttributeList *AList::as_attr_list(Arena &arena) {
+    auto attr_list = arena.create<AttributeList>(std::move(attributes));
     attributes.clear();
     return attr_list;
 }
@@ -105,13 +82,10 @@ bool Statement::is_instance(Expression *e) {
     }
 }
 
-EdgeStmt::EdgeStmt(std::string n1name, std::string n2name, AttributeList *attrs)
+EdgeStmt::EdgeStmt(std::string_view n1name, std::string_view n2name,
+                   AttributeList *attrs)
     : node1_name{n1name}, node2_name{n2name}, attr_list{attrs} {}
 
-EdgeStmt::~EdgeStmt() {
-    delete attr_list;
-}
-
 ExprType EdgeStmt::type() {
     return ExprType::STATEMENT;
 }
@@ -120,13 +94,53 @@ void EdgeStmt::apply_to_graph(Graph &g) {
     double distance = 1.0;
     if (attr_list) {
         if (auto weight = attr_list->get_attr("weight"); weight.has_value()) {
-            distance = std::stod(weight.value());
+            distance = std::stod(std::string{weight.value()});
+        }
+    }
+    g.add_edge(NodeName{node1_name}, NodeName{node2_name}, distance);
+}
+
+NodeStmt::NodeStmt(std::string_view name, AttributeList *attrs)
+    : node_name{name}, attr_list{attrs} {}
+
+ExprType NodeStmt::type() {
+    return ExprType::STATEMENT;
+}
+
+/**
+ * Parse a position of the form "x,y", optionally followed by '!' as written
+ * by graphviz for pinned nodes.
+ */
+static Position parse_position(std::string_view pos_value) {
+    std::string pos{pos_value};
+    std::size_t comma = pos.find(',');
+    try {
+        if (comma != std::string::npos) {
+            std::size_t x_end, y_end;
+            double x = std::stod(pos.substr(0, comma), &x_end);
+            std::string y_str = pos.substr(comma + 1);
+            double y = std::stod(y_str, &y_end);
+            if (x_end == comma &&
+                (y_end == y_str.size() || y_str.substr(y_end) == "!")) {
+                return Position{x, y};
+            }
+        }
+    } catch (const std::logic_error &) {
+        // handled below
+    }
+    throw std::runtime_error{"invalid position: " + pos};
+}
+
+void NodeStmt::apply_to_graph(Graph &g) {
+    g.add_node(NodeName{node_name});
+    if (attr_list) {
+        if (auto pos = attr_list->get_attr("pos"); pos.has_value()) {
+            g.set_position(NodeName{node_name}, parse_position(pos.value()));
         }
     }
-    g.add_edge(node1_name, node2_name, distance);
 }
 
-StmtList::StmtList() : statements{} {}
+StmtList::StmtList(std::pmr::memory_resource *memory) : statements{memory} {}
 
 ExprType StmtList::type() {
     return ExprType::STMT_LIST;
@@ -138,25 +152,26 @@ void StmtList::apply_to_graph(Graph &g) {
     }
 }
 
-StmtList::~StmtList() {
-    for (auto s : statements) {
-        delete s;
-    }
-}
-
 void StmtList::add_statement(Statement *s) {
     statements.push_back(s);
 }
 
+void StmtList::flush_into(Graph &g) {
+    for (auto s : statements) {
+        s->apply_to_graph(g);
+    }
+    statements.clear();
+}
+
 bool StmtList::is_instance(Expression *e) {
     return e->type() == ExprType::STMT_LIST;
 }
 
-FullGraph::FullGraph(std::string name, StmtList *stmtList)
+FullGraph::FullGraph(std::string_view name, StmtList *stmtList)
     : name{name}, stmtList{stmtList} {}
 
 void FullGraph::apply_to_graph(Graph &g) {
-    g.set_name(name);
+    g.set_name(std::string{name});
     stmtList->apply_to_graph(g);
 }
 
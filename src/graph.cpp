@@ -1,97 +1,882 @@
 #include <graphd/graph.hpp>
+#include <graphd/heuristic.hpp>
+#include <graphd/matrix.hpp>
+#include <graphd/pool.hpp>
+#include <graphd/workspace.hpp>
 
 #include <algorithm>
-#include <limits>
+#include <cmath>
+#include <map>
+#include <numeric>
+#include <set>
 #include <stdexcept>
+#include <tuple>
+#include <utility>
 
 namespace graphd {
 
-// NOTE: map.contains() not available in C++17
-template <typename K, typename V>
-static bool contains(std::unordered_map<K, V> &map, K key) {
-    return map.find(key) != map.end();
+static double keep_shortest(DistMap &map, NodeId n, double dist) {
+    auto [it, inserted] = map.try_emplace(n, dist);
+    if (!inserted && dist < it->second) {
+        it->second = dist;
+    }
+    return it->second;
+}
+
+void Node::add_neighbor(NodeId n, double distance) {
+    keep_shortest(neighbors, n, distance);
 }
 
-static double keep_shortest(DistMap &map, NodeName n, double dist) {
-    if (contains(map, n)) {
-        double current_dist = map[n];
-        if (dist < current_dist) {
-            map[n] = dist;
-            return dist;
-        } else {
-            return current_dist;
+Path Graph::dijkstra(NodeId start, NodeId end, SearchWorkspace &ws) const {
+    SearchState &state = ws.forward;
+    state.reset(node_count());
+    state.relax(start, 0.0, no_node);
+
+    while (state.has_next()) {
+        NodeId node = state.pop();
+        if (node == end) {
+            return trace_path(start, end, ws);
+        }
+
+        double node_dist = state.distance(node);
+        for (auto e = edges_begin(node); e < edges_end(node); e++) {
+            state.relax(edge_target(e), node_dist + edge_weight(e), node);
         }
-    } else {
-        map[n] = dist;
-        return dist;
     }
-}
 
-void Node::add_neighbor(NodeName n, double distance) {
-    keep_shortest(neighbors, n, distance);
+    throw not_connected(start, end);
 }
 
-Path Graph::dijkstra(NodeName start, NodeName end) {
-    DistMap distances = {{start, 0.0}};
-    std::unordered_map<NodeName, NodeName> previous_hop;
+Path Graph::bidirectional(NodeId start, NodeId end, SearchWorkspace &ws) const {
+    SearchState &fwd = ws.forward;
+    SearchState &bwd = ws.backward;
+    fwd.reset(node_count());
+    bwd.reset(node_count());
+    fwd.relax(start, 0.0, no_node);
+    bwd.relax(end, 0.0, no_node);
 
-    while (!contains(distances, end)) {
-        double shortest_next_distance = std::numeric_limits<double>::max();
-        // Which node to add in this step, connecting from prev
-        NodeName next = "";
-        NodeName prev = "";
+    // Length of the shortest path found so far, and the node where its
+    // forward and backward halves meet.
+    double best = start == end ? 0.0 : infinity;
+    NodeId meeting = start;
 
-        // Explore options for the next step
-        for (auto [node, node_dist] : distances) {
-            for (auto [neighbor, dist_from_node] : nodes[node].neighbors) {
-                if (contains(distances, neighbor)) {
-                    // already mapped
-                    continue;
-                }
+    while (fwd.has_next() && bwd.has_next()) {
+        // No path through an unsettled node can be shorter than this.
+        if (fwd.next_priority() + bwd.next_priority() >= best) {
+            break;
+        }
 
-                double total_dist = node_dist + dist_from_node;
-                if (total_dist < shortest_next_distance) {
-                    shortest_next_distance = total_dist;
-                    next = neighbor;
-                    prev = node;
-                }
+        // Graphs are undirected, both searches use the same edges.
+        bool forward = fwd.next_priority() <= bwd.next_priority();
+        SearchState &self = forward ? fwd : bwd;
+        const SearchState &other = forward ? bwd : fwd;
+
+        NodeId node = self.pop();
+        double node_dist = self.distance(node);
+        for (auto e = edges_begin(node); e < edges_end(node); e++) {
+            NodeId neighbor = edge_target(e);
+            self.relax(neighbor, node_dist + edge_weight(e), node);
+
+            double through = self.distance(neighbor) + other.distance(neighbor);
+            if (through < best) {
+                best = through;
+                meeting = neighbor;
             }
         }
+    }
+
+    if (best == infinity) {
+        throw not_connected(start, end);
+    }
+
+    std::vector<NodeName> hops;
+    for (NodeId n = meeting; n != start; n = fwd.parent(n)) {
+        hops.emplace_back(name_of(n));
+    }
+    hops.emplace_back(name_of(start));
+    std::reverse(hops.begin(), hops.end());
+    for (NodeId n = meeting; n != end; n = bwd.parent(n)) {
+        hops.emplace_back(name_of(bwd.parent(n)));
+    }
+
+    return Path{best, hops};
+}
+
+Path Graph::astar(NodeId start, NodeId end, SearchWorkspace &ws,
+                  const Heuristic &h) const {
+    SearchState &state = ws.forward;
+    state.reset(node_count());
+    state.relax(start, 0.0, no_node, h.estimate(start, end));
 
-        if (next == "") {
-            throw std::runtime_error{"nodes not connected: " + start + ", " +
-                                     end};
+    while (state.has_next()) {
+        NodeId node = state.pop();
+        if (node == end) {
+            return trace_path(start, end, ws);
         }
 
-        distances[next] = shortest_next_distance;
-        previous_hop[next] = prev;
+        // Nodes are queued by distance plus the estimated remaining distance.
+        // Should the heuristic be inconsistent, relax() reopens settled nodes
+        // that turn out to be reachable on a shorter path.
+        double node_dist = state.distance(node);
+        for (auto e = edges_begin(node); e < edges_end(node); e++) {
+            NodeId neighbor = edge_target(e);
+            double dist = node_dist + edge_weight(e);
+            if (dist < state.distance(neighbor)) {
+                state.relax(neighbor, dist, node,
+                            dist + h.estimate(neighbor, end));
+            }
+        }
     }
 
+    throw not_connected(start, end);
+}
+
+std::runtime_error Graph::not_connected(NodeId start, NodeId end) const {
+    return std::runtime_error{"nodes not connected: " +
+                              NodeName{name_of(start)} + ", " +
+                              NodeName{name_of(end)}};
+}
+
+Path Graph::trace_path(NodeId start, NodeId end,
+                       const SearchWorkspace &ws) const {
     // Trace the path backwards from end to start, building the path in reverse.
+    // Names are only looked up here, the search itself works on IDs.
     std::vector<NodeName> hops;
-    for (NodeName n = end; n != start; n = previous_hop[n]) {
-        hops.push_back(n);
+    for (NodeId n = end; n != start; n = ws.forward.parent(n)) {
+        hops.emplace_back(name_of(n));
     }
-    hops.push_back(start);
+    hops.emplace_back(name_of(start));
 
     std::reverse(hops.begin(), hops.end());
 
-    return Path{distances[end], hops};
+    return Path{ws.forward.distance(end), hops};
+}
+
+Path Graph::shortest_path(NodeName from, NodeName to) const {
+    SearchWorkspace ws;
+    return shortest_path(from, to, ws);
+}
+
+Path Graph::shortest_path(NodeName from, NodeName to, SearchWorkspace &ws,
+                          Algorithm algorithm) const {
+    if (!frozen) {
+        throw std::logic_error{"graph must be frozen before querying"};
+    }
+    NodeId start = id_of(from);
+    NodeId end = id_of(to);
+
+    switch (algorithm) {
+    case Algorithm::DIJKSTRA:
+        return dijkstra(start, end, ws);
+    case Algorithm::BIDIRECTIONAL:
+        return bidirectional(start, end, ws);
+    case Algorithm::ASTAR:
+        return astar(start, end, ws, EuclideanHeuristic{*this});
+    default:
+        throw std::logic_error{"unknown search algorithm"};
+    }
+}
+
+Path Graph::shortest_path(NodeName from, NodeName to, SearchWorkspace &ws,
+                          const Heuristic &h) const {
+    if (!frozen) {
+        throw std::logic_error{"graph must be frozen before querying"};
+    }
+    h.check_current();
+    NodeId start = id_of(from);
+    NodeId end = id_of(to);
+    return astar(start, end, ws, h);
+}
+
+ShortestPathTree Graph::shortest_path_tree(NodeName from) const {
+    SearchWorkspace ws;
+    return shortest_path_tree(id_of(from), ws);
+}
+
+ShortestPathTree Graph::shortest_path_tree(NodeId start,
+                                           SearchWorkspace &ws) const {
+    if (!frozen) {
+        throw std::logic_error{"graph must be frozen before querying"};
+    }
+    if (start >= node_count()) {
+        throw std::out_of_range{"no node with ID " + std::to_string(start)};
+    }
+
+    SearchState &state = ws.forward;
+    state.reset(node_count());
+    state.relax(start, 0.0, no_node);
+    while (state.has_next()) {
+        NodeId node = state.pop();
+        double node_dist = state.distance(node);
+        for (auto e = edges_begin(node); e < edges_end(node); e++) {
+            state.relax(edge_target(e), node_dist + edge_weight(e), node);
+        }
+    }
+
+    ShortestPathTree tree{start, {}, {}};
+    tree.distance.resize(node_count());
+    tree.predecessor.resize(node_count());
+    for (NodeId n = 0; n < node_count(); n++) {
+        tree.distance[n] = state.distance(n);
+        tree.predecessor[n] = state.parent(n);
+    }
+    return tree;
+}
+
+/**
+ * An offer of a path of length dist to target, reaching it from parent.
+ */
+struct Relaxation {
+    NodeId target;
+    NodeId parent;
+    double dist;
+};
+
+/**
+ * The nodes one thread of a delta-stepping search is responsible for: those
+ * with IDs equal to its index modulo the number of parts. Only the owning
+ * part changes the distance, predecessor and bucket of a node, so parts need
+ * no locks, just a barrier between offering and applying relaxations.
+ */
+struct StepPart {
+    // Nodes by bucket, including stale entries for nodes that have moved on
+    // to an earlier bucket since
+    std::map<double, std::vector<NodeId>> buckets;
+    // Nodes settled in the current bucket, whose heavy edges are yet to be
+    // relaxed. Nodes improved on within the bucket are listed again.
+    std::vector<NodeId> settled;
+    // Relaxations offered by this part, by the part owning their target
+    std::vector<std::vector<Relaxation>> offers;
+};
+
+ShortestPathTree Graph::shortest_path_tree(NodeId start, ThreadPool &pool,
+                                           double delta) const {
+    if (!frozen) {
+        throw std::logic_error{"graph must be frozen before querying"};
+    }
+    if (start >= node_count()) {
+        throw std::out_of_range{"no node with ID " + std::to_string(start)};
+    }
+    if (delta == 0) {
+        double total = 0;
+        std::size_t count = 0;
+        for (std::uint64_t e = 0; e < targets.size(); e++) {
+            if (edge_weight(e) < infinity) {
+                total += edge_weight(e);
+                count++;
+            }
+        }
+        delta = count > 0 && total > 0 ? total / count : 1;
+    }
+    if (!(delta > 0 && delta < infinity)) {
+        throw std::runtime_error{"invalid delta: " + std::to_string(delta)};
+    }
+
+    ShortestPathTree tree{start, std::vector<double>(node_count(), infinity),
+                          std::vector<NodeId>(node_count(), no_node)};
+    std::vector<double> &dist = tree.distance;
+    // The distance each node's light edges were relaxed at last, if any
+    std::vector<double> expanded(node_count(), infinity);
+
+    std::size_t part_count = pool.size();
+    std::vector<StepPart> parts(part_count);
+    for (StepPart &part : parts) {
+        part.offers.resize(part_count);
+    }
+    auto bucket_of = [delta](double d) { return std::floor(d / delta); };
+
+    // Run f(part, index) for each part on the pool, and wait for all.
+    auto for_each_part = [&pool, &parts](auto f) {
+        for (std::size_t p = 0; p < parts.size(); p++) {
+            pool.submit([&f, &parts, p](unsigned) { f(parts[p], p); });
+        }
+        pool.wait();
+    };
+    // Offer the paths along the edges of node whose weight is within
+    // bounds. Distances only change while applying, so any may be read.
+    auto offer = [&](StepPart &part, NodeId node, bool light) {
+        for (auto e = edges_begin(node); e < edges_end(node); e++) {
+            double weight = edge_weight(e);
+            NodeId target = edge_target(e);
+            double d = dist[node] + weight;
+            if ((weight <= delta) == light && d < dist[target]) {
+                part.offers[target % part_count].push_back(
+                    {target, node, d});
+            }
+        }
+    };
+    // Apply the best offers made for nodes of part, bucketing those whose
+    // distance went down.
+    auto apply = [&](StepPart &part, std::size_t index) {
+        for (StepPart &from : parts) {
+            for (const Relaxation &r : from.offers[index]) {
+                if (r.dist < dist[r.target]) {
+                    dist[r.target] = r.dist;
+                    tree.predecessor[r.target] = r.parent;
+                    part.buckets[bucket_of(r.dist)].push_back(r.target);
+                }
+            }
+            from.offers[index].clear();
+        }
+    };
+
+    dist[start] = 0;
+    parts[start % part_count].buckets[0].push_back(start);
+    while (true) {
+        // The lowest bucket any part has nodes in
+        double current = infinity;
+        for (const StepPart &part : parts) {
+            if (!part.buckets.empty()) {
+                current = std::min(current, part.buckets.begin()->first);
+            }
+        }
+        if (current == infinity) {
+            break;
+        }
+
+        // Light edges may lead back into the current bucket, relax them
+        // until it stays empty.
+        bool refilled = true;
+        while (refilled) {
+            for_each_part([&](StepPart &part, std::size_t) {
+                auto bucket = part.buckets.find(current);
+                if (bucket == part.buckets.end()) {
+                    return;
+                }
+                std::vector<NodeId> nodes = std::move(bucket->second);
+                part.buckets.erase(bucket);
+                for (NodeId node : nodes) {
+                    // Skip stale entries, and nodes listed more than once.
+                    if (bucket_of(dist[node]) != current ||
+                        expanded[node] == dist[node]) {
+                        continue;
+                    }
+                    expanded[node] = dist[node];
+                    part.settled.push_back(node);
+                    offer(part, node, true);
+                }
+            });
+            for_each_part(apply);
+            refilled = false;
+            for (const StepPart &part : parts) {
+                refilled = refilled || part.buckets.count(current) > 0;
+            }
+        }
+
+        // Heavy edges lead to later buckets only, relax them once.
+        for_each_part([&](StepPart &part, std::size_t) {
+            for (NodeId node : part.settled) {
+                offer(part, node, false);
+            }
+            part.settled.clear();
+        });
+        for_each_part(apply);
+    }
+    return tree;
+}
+
+double Graph::edge_between(NodeId n1, NodeId n2) const {
+    for (auto e = edges_begin(n1); e < edges_end(n1); e++) {
+        if (edge_target(e) == n2) {
+            return edge_weight(e);
+        }
+    }
+    throw std::logic_error{"no edge between nodes on a path"};
+}
+
+std::optional<std::vector<NodeId>>
+Graph::spur_path(NodeId spur, NodeId end, const std::vector<NodeId> &blocked,
+                 SearchWorkspace &ws) const {
+    const SearchState &tree = ws.backward;
+    auto is_excluded = [&ws](NodeId n) {
+        return ws.excluded[n] == ws.exclusion;
+    };
+    auto is_blocked = [&blocked](NodeId n) {
+        return std::find(blocked.begin(), blocked.end(), n) != blocked.end();
+    };
+
+    // Exclusions only ever make paths longer, so if the tree path to the
+    // target avoids them, it is still a shortest one.
+    std::vector<NodeId> path;
+    if (spur != end && !is_blocked(tree.parent(spur))) {
+        NodeId n = tree.parent(spur);
+        while (n != no_node && !is_excluded(n)) {
+            path.push_back(n);
+            n = tree.parent(n);
+        }
+        if (n == no_node) {
+            return path;
+        }
+    }
+
+    // Distances to the target in the full graph are a consistent lower
+    // bound for the graph with exclusions.
+    SearchState &state = ws.forward;
+    state.reset(node_count());
+    state.relax(spur, 0.0, no_node, tree.distance(spur));
+    while (state.has_next()) {
+        NodeId node = state.pop();
+        if (node == end) {
+            path.clear();
+            for (NodeId n = end; n != spur; n = state.parent(n)) {
+                path.push_back(n);
+            }
+            std::reverse(path.begin(), path.end());
+            return path;
+        }
+
+        double node_dist = state.distance(node);
+        for (auto e = edges_begin(node); e < edges_end(node); e++) {
+            NodeId neighbor = edge_target(e);
+            double remaining = tree.distance(neighbor);
+            if (is_excluded(neighbor) || remaining == infinity ||
+                (node == spur && is_blocked(neighbor))) {
+                continue;
+            }
+            double dist = node_dist + edge_weight(e);
+            if (dist < state.distance(neighbor)) {
+                state.relax(neighbor, dist, node, dist + remaining);
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<Path> Graph::k_shortest_paths(NodeName from, NodeName to,
+                                          std::size_t k) const {
+    SearchWorkspace ws;
+    return k_shortest_paths(from, to, k, ws);
+}
+
+std::vector<Path> Graph::k_shortest_paths(NodeName from, NodeName to,
+                                          std::size_t k,
+                                          SearchWorkspace &ws) const {
+    if (!frozen) {
+        throw std::logic_error{"graph must be frozen before querying"};
+    }
+    NodeId start = id_of(from);
+    NodeId end = id_of(to);
+
+    // The tree of shortest paths to the target yields the shortest path
+    // itself and guides all spur searches.
+    SearchState &tree = ws.backward;
+    tree.reset(node_count());
+    tree.relax(end, 0.0, no_node);
+    while (tree.has_next()) {
+        NodeId node = tree.pop();
+        double node_dist = tree.distance(node);
+        for (auto e = edges_begin(node); e < edges_end(node); e++) {
+            tree.relax(edge_target(e), node_dist + edge_weight(e), node);
+        }
+    }
+    if (tree.distance(start) == infinity) {
+        throw not_connected(start, end);
+    }
+    if (ws.excluded.size() != node_count()) {
+        ws.excluded.assign(node_count(), 0);
+        ws.exclusion = 0;
+    }
+
+    // A path along with the distance from the start to each of its nodes,
+    // summed in path order so that equal paths have equal lengths.
+    struct Candidate {
+        std::vector<NodeId> nodes;
+        std::vector<double> distances;
+        // Index of the node where the path leaves the one it was derived
+        // from. Spurs from earlier nodes only yield known paths again.
+        std::size_t deviation;
+        bool operator<(const Candidate &other) const {
+            return std::tie(distances.back(), nodes) <
+                   std::tie(other.distances.back(), other.nodes);
+        }
+    };
+    auto make_candidate = [this](std::vector<NodeId> nodes,
+                                 std::size_t deviation) {
+        std::vector<double> distances{0.0};
+        for (std::size_t i = 1; i < nodes.size(); i++) {
+            distances.push_back(distances.back() +
+                                edge_between(nodes[i - 1], nodes[i]));
+        }
+        return Candidate{std::move(nodes), std::move(distances), deviation};
+    };
+
+    std::vector<NodeId> shortest{start};
+    for (NodeId n = start; n != end; n = tree.parent(n)) {
+        shortest.push_back(tree.parent(n));
+    }
+    std::vector<Candidate> found;
+    std::set<Candidate> candidates;
+    std::set<std::vector<NodeId>> seen{shortest};
+    if (k > 0) {
+        found.push_back(make_candidate(std::move(shortest), 0));
+    }
+
+    std::vector<NodeId> blocked;
+    while (found.size() < k) {
+        const Candidate &last = found.back();
+        for (std::size_t i = last.deviation; i + 1 < last.nodes.size(); i++) {
+            NodeId spur = last.nodes[i];
+            // The root path up to the spur node is fixed: no going back to
+            // its nodes, nor on to a node that continues a path found before.
+            if (++ws.exclusion == 0) {
+                std::fill(ws.excluded.begin(), ws.excluded.end(), 0);
+                ws.exclusion = 1;
+            }
+            for (std::size_t j = 0; j < i; j++) {
+                ws.excluded[last.nodes[j]] = ws.exclusion;
+            }
+            blocked.clear();
+            for (const Candidate &path : found) {
+                if (path.nodes.size() > i + 1 &&
+                    std::equal(path.nodes.begin(), path.nodes.begin() + i + 1,
+                               last.nodes.begin())) {
+                    blocked.push_back(path.nodes[i + 1]);
+                }
+            }
+
+            auto spur_nodes = spur_path(spur, end, blocked, ws);
+            if (!spur_nodes.has_value()) {
+                continue;
+            }
+            std::vector<NodeId> nodes(last.nodes.begin(),
+                                      last.nodes.begin() + i + 1);
+            nodes.insert(nodes.end(), spur_nodes->begin(), spur_nodes->end());
+            if (seen.insert(nodes).second) {
+                candidates.insert(make_candidate(std::move(nodes), i));
+            }
+        }
+
+        if (candidates.empty()) {
+            break;
+        }
+        auto next = candidates.extract(candidates.begin());
+        found.push_back(std::move(next.value()));
+    }
+
+    std::vector<Path> paths;
+    for (const Candidate &c : found) {
+        std::vector<NodeName> hops;
+        for (NodeId n : c.nodes) {
+            hops.emplace_back(name_of(n));
+        }
+        paths.push_back(Path{c.distances.back(), std::move(hops)});
+    }
+    return paths;
 }
 
-Path Graph::shortest_path(NodeName from, NodeName to) {
-    if (!contains(nodes, from)) {
-        throw std::runtime_error{"no such node: " + from};
+DistanceMatrix Graph::distance_matrix(const std::vector<NodeName> &sources,
+                                      const std::vector<NodeName> &targets,
+                                      unsigned threads) const {
+    if (!frozen) {
+        throw std::logic_error{"graph must be frozen before querying"};
     }
-    if (!contains(nodes, to)) {
-        throw std::runtime_error{"no such node: " + to};
+    std::vector<NodeId> from;
+    for (const NodeName &n : sources) {
+        from.push_back(id_of(n));
+    }
+    std::vector<NodeId> to;
+    std::vector<bool> is_target(node_count());
+    std::size_t distinct_targets = 0;
+    for (const NodeName &n : targets) {
+        NodeId id = id_of(n);
+        to.push_back(id);
+        if (!is_target[id]) {
+            is_target[id] = true;
+            distinct_targets++;
+        }
     }
 
-    return dijkstra(from, to);
+    DistanceMatrix matrix{from.size(), to.size()};
+    ThreadPool pool{threads};
+    std::vector<SearchWorkspace> workspaces(pool.size());
+    for (std::size_t row = 0; row < from.size(); row++) {
+        pool.submit([&, row](unsigned worker) {
+            SearchState &state = workspaces[worker].forward;
+            state.reset(node_count());
+            state.relax(from[row], 0.0, no_node);
+            std::size_t remaining = distinct_targets;
+            while (remaining > 0 && state.has_next()) {
+                NodeId node = state.pop();
+                if (is_target[node]) {
+                    remaining--;
+                }
+                double node_dist = state.distance(node);
+                for (auto e = edges_begin(node); e < edges_end(node); e++) {
+                    state.relax(edge_target(e), node_dist + edge_weight(e),
+                                node);
+                }
+            }
+            for (std::size_t column = 0; column < to.size(); column++) {
+                matrix.at(row, column) = state.distance(to[column]);
+            }
+        });
+    }
+    pool.wait();
+    return matrix;
 }
 
 void Graph::set_name(std::string name) {
-    this->name = name;
+    graph_name = std::move(name);
+}
+
+const std::string &Graph::name() const {
+    return graph_name;
+}
+
+std::size_t Graph::node_count() const {
+    return frozen ? offsets.size() - 1 : names.size();
+}
+
+std::size_t Graph::edge_count() const {
+    return targets.size() / 2;
+}
+
+std::optional<Position> Graph::position(NodeId n) const {
+    const Position *pos = nullptr;
+    if (frozen ? n < positions.size() : n < node_positions.size()) {
+        pos = frozen ? &positions[n] : &node_positions[n];
+    }
+    if (pos == nullptr || std::isnan(pos->x)) {
+        return std::nullopt;
+    }
+    return *pos;
+}
+
+bool Graph::is_frozen() const {
+    return frozen;
+}
+
+void Graph::freeze() {
+    if (frozen) {
+        return;
+    }
+
+    std::vector<std::uint64_t> csr_offsets(nodes.size() + 1, 0);
+    for (std::size_t n = 0; n < nodes.size(); n++) {
+        csr_offsets[n + 1] = csr_offsets[n] + nodes[n].neighbors.size();
+    }
+
+    std::vector<NodeId> csr_targets(csr_offsets.back());
+    std::vector<double> csr_weights(csr_offsets.back());
+    std::vector<std::pair<NodeId, double>> adjacent;
+    for (std::size_t n = 0; n < nodes.size(); n++) {
+        // Sort neighbors for a layout independent of hash map iteration order.
+        adjacent.assign(nodes[n].neighbors.begin(), nodes[n].neighbors.end());
+        std::sort(adjacent.begin(), adjacent.end());
+        auto i = csr_offsets[n];
+        for (auto [neighbor, weight] : adjacent) {
+            csr_targets[i] = neighbor;
+            csr_weights[i] = weight;
+            i++;
+        }
+    }
+    offsets = std::move(csr_offsets);
+    targets = std::move(csr_targets);
+    weights = std::move(csr_weights);
+
+    if (!node_positions.empty()) {
+        node_positions.resize(nodes.size(), Position{NAN, NAN});
+        positions = std::move(node_positions);
+    }
+
+    freeze_names();
+
+    // Release the builder state, including its capacity.
+    std::vector<Node>{}.swap(nodes);
+    frozen = true;
+}
+
+void Graph::freeze_names() {
+    std::vector<std::uint64_t> offs(names.size() + 1, 0);
+    for (std::size_t n = 0; n < names.size(); n++) {
+        offs[n + 1] = offs[n] + names[n].size();
+    }
+
+    std::vector<char> chars;
+    chars.reserve(offs.back());
+    for (const NodeName &n : names) {
+        chars.insert(chars.end(), n.begin(), n.end());
+    }
+
+    std::vector<NodeId> sorted(names.size());
+    std::iota(sorted.begin(), sorted.end(), 0);
+    std::sort(sorted.begin(), sorted.end(),
+              [this](NodeId a, NodeId b) { return names[a] < names[b]; });
+
+    name_offsets = std::move(offs);
+    name_chars = std::move(chars);
+    sorted_ids = std::move(sorted);
+    decltype(ids){}.swap(ids);
+    decltype(names){}.swap(names);
+}
+
+NodeId Graph::id_of(const NodeName &n) const {
+    if (!frozen) {
+        auto it = ids.find(n);
+        if (it == ids.end()) {
+            throw std::runtime_error{"no such node: " + n};
+        }
+        return it->second;
+    }
+
+    auto it = std::lower_bound(
+        sorted_ids.begin(), sorted_ids.end(), n,
+        [this](NodeId id, const NodeName &n) { return name_of(id) < n; });
+    if (it == sorted_ids.end() || name_of(*it) != n) {
+        throw std::runtime_error{"no such node: " + n};
+    }
+    return *it;
+}
+
+std::string_view Graph::name_of(NodeId id) const {
+    if (id >= node_count()) {
+        throw std::out_of_range{"no node with ID " + std::to_string(id)};
+    }
+    if (!frozen) {
+        return names[id];
+    }
+    return std::string_view{name_chars.data() + name_offsets[id],
+                            name_offsets[id + 1] - name_offsets[id]};
+}
+
+void Graph::add_node(NodeName n) {
+    if (frozen) {
+        throw std::logic_error{"cannot add nodes to a frozen graph"};
+    }
+    intern(n);
+}
+
+void Graph::set_position(NodeName n, Position pos) {
+    if (frozen) {
+        throw std::logic_error{"cannot modify a frozen graph"};
+    }
+    NodeId id = intern(n);
+    if (node_positions.size() <= id) {
+        node_positions.resize(id + 1, Position{NAN, NAN});
+    }
+    node_positions[id] = pos;
+}
+
+void Graph::merge(std::vector<Graph> parts, ThreadPool &pool) {
+    if (frozen) {
+        throw std::logic_error{"cannot add edges to a frozen graph"};
+    }
+
+    // Symbol tables are merged in order, so that IDs follow the order of
+    // first appearance. ids[p][n] is the ID of node n of part p in this graph.
+    std::vector<std::vector<NodeId>> ids(parts.size());
+    for (std::size_t p = 0; p < parts.size(); p++) {
+        Graph &part = parts[p];
+        if (part.frozen) {
+            throw std::logic_error{"cannot merge a frozen graph"};
+        }
+        ids[p].reserve(part.names.size());
+        for (NodeName &name : part.names) {
+            ids[p].push_back(intern(std::move(name)));
+        }
+        // Later positions override earlier ones.
+        for (std::size_t n = 0; n < part.node_positions.size(); n++) {
+            if (!std::isnan(part.node_positions[n].x)) {
+                NodeId id = ids[p][n];
+                if (node_positions.size() <= id) {
+                    node_positions.resize(id + 1, Position{NAN, NAN});
+                }
+                node_positions[id] = part.node_positions[n];
+            }
+        }
+    }
+
+    // Each worker owns a range of nodes in this graph and only modifies
+    // their adjacency.
+    std::size_t workers = pool.size();
+    std::size_t per_worker = (nodes.size() + workers - 1) / workers;
+    for (std::size_t w = 0; w < workers; w++) {
+        NodeId lo = std::min(nodes.size(), w * per_worker);
+        NodeId hi = std::min(nodes.size(), (w + 1) * per_worker);
+        pool.submit([this, &parts, &ids, lo, hi](unsigned) {
+            for (std::size_t p = 0; p < parts.size(); p++) {
+                const std::vector<NodeId> &to_global = ids[p];
+                for (std::size_t n = 0; n < to_global.size(); n++) {
+                    NodeId id = to_global[n];
+                    if (id < lo || id >= hi) {
+                        continue;
+                    }
+                    const Node &node = parts[p].nodes[n];
+                    for (auto [neighbor, weight] : node.neighbors) {
+                        nodes[id].add_neighbor(to_global[neighbor], weight);
+                    }
+                }
+            }
+        });
+    }
+    pool.wait();
+}
+
+NodeId Graph::intern(NodeName n) {
+    auto [it, inserted] = ids.try_emplace(n, NodeId(names.size()));
+    if (inserted) {
+        if (names.size() == no_node) {
+            // Leave the graph as it was.
+            ids.erase(it);
+            throw std::runtime_error{"too many nodes"};
+        }
+        names.push_back(n);
+        nodes.emplace_back();
+    }
+    return it->second;
+}
+
+double Graph::set_edge_weight(NodeName n1, NodeName n2, double weight) {
+    return set_edge_weight(id_of(n1), id_of(n2), weight);
+}
+
+double Graph::set_edge_weight(NodeId n1, NodeId n2, double weight) {
+    if (!(weight >= 0)) {
+        throw std::runtime_error{"negative edge weight not permitted: " +
+                                 std::to_string(weight)};
+    }
+    if (n1 >= node_count() || n2 >= node_count()) {
+        throw std::out_of_range{"no node with ID " +
+                                std::to_string(std::max(n1, n2))};
+    }
+
+    double previous = infinity;
+    bool found = false;
+    if (!frozen) {
+        for (auto [from, to] : {std::pair{n1, n2}, std::pair{n2, n1}}) {
+            if (auto it = nodes[from].neighbors.find(to);
+                it != nodes[from].neighbors.end()) {
+                previous = std::exchange(it->second, weight);
+                found = true;
+            }
+        }
+    } else {
+        double *w = weights.mutable_data();
+        for (auto [from, to] : {std::pair{n1, n2}, std::pair{n2, n1}}) {
+            // Neighbors are sorted by ID.
+            const NodeId *first = targets.data() + offsets[from];
+            const NodeId *last = targets.data() + offsets[from + 1];
+            const NodeId *it = std::lower_bound(first, last, to);
+            if (it != last && *it == to) {
+                previous = std::exchange(w[it - targets.data()], weight);
+                found = true;
+            }
+        }
+    }
+    if (!found) {
+        throw std::runtime_error{"no edge between " + NodeName{name_of(n1)} +
+                                 " and " + NodeName{name_of(n2)}};
+    }
+    edits++;
+    return previous;
+}
+
+double Graph::remove_edge(NodeName n1, NodeName n2) {
+    return set_edge_weight(n1, n2, infinity);
+}
+
+std::uint64_t Graph::revision() const {
+    return edits;
 }
 
 void Graph::add_edge(NodeName n1, NodeName n2, double weight) {
@@ -100,14 +885,18 @@ void Graph::add_edge(NodeName n1, NodeName n2, double weight) {
                                  std::to_string(weight)};
     }
 
+    if (frozen) {
+        throw std::logic_error{"cannot add edges to a frozen graph"};
+    }
+
     if (n1 == n2) {
         return;
     }
 
-    nodes.try_emplace(n1);
-    nodes.try_emplace(n2);
+    NodeId id1 = intern(n1);
+    NodeId id2 = intern(n2);
 
-    nodes[n1].add_neighbor(n2, weight);
-    nodes[n2].add_neighbor(n1, weight);
+    nodes[id1].add_neighbor(id2, weight);
+    nodes[id2].add_neighbor(id1, weight);
 }
 } // namespace graphd
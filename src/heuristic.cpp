@@ -0,0 +1,45 @@
+#include <graphd/heuristic.hpp>
+#include <graphd/landmarks.hpp>
+
+#include <cmath>
+#include <stdexcept>
+
+namespace graphd {
+
+EuclideanHeuristic::EuclideanHeuristic(const Graph &g) : graph{g} {}
+
+double EuclideanHeuristic::estimate(NodeId from, NodeId to) const {
+    auto p = graph.position(from);
+    auto q = graph.position(to);
+    if (!p.has_value() || !q.has_value()) {
+        return 0.0;
+    }
+    return std::hypot(p->x - q->x, p->y - q->y);
+}
+
+ManhattanHeuristic::ManhattanHeuristic(const Graph &g) : graph{g} {}
+
+double ManhattanHeuristic::estimate(NodeId from, NodeId to) const {
+    auto p = graph.position(from);
+    auto q = graph.position(to);
+    if (!p.has_value() || !q.has_value()) {
+        return 0.0;
+    }
+    return std::abs(p->x - q->x) + std::abs(p->y - q->y);
+}
+
+std::unique_ptr<Heuristic> make_heuristic(const std::string &name,
+                                          const Graph &g) {
+    if (name == "euclidean") {
+        return std::make_unique<EuclideanHeuristic>(g);
+    }
+    if (name == "manhattan") {
+        return std::make_unique<ManhattanHeuristic>(g);
+    }
+    if (name == "landmarks") {
+        return std::make_unique<LandmarkHeuristic>(g);
+    }
+    throw std::runtime_error{"unknown heuristic: " + name};
+}
+
+} // namespace graphd
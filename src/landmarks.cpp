@@ -0,0 +1,87 @@
+#include <graphd/landmarks.hpp>
+#include <graphd/workspace.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graphd {
+
+LandmarkHeuristic::LandmarkHeuristic(const Graph &g, unsigned count)
+    : g{g}, revision{g.revision()} {
+    if (!g.is_frozen()) {
+        throw std::logic_error{"graph must be frozen before preprocessing"};
+    }
+    std::size_t n = g.node_count();
+    count = std::min<std::size_t>(count, n);
+
+    // Distance of each node to the nearest landmark picked so far. The
+    // first landmark is the node farthest from node 0.
+    std::vector<double> nearest(n, infinity);
+    std::vector<NodeId> picked;
+    std::vector<double> table(n * count, infinity);
+    SearchWorkspace ws;
+    NodeId next = 0;
+    if (n > 0) {
+        ShortestPathTree tree = g.shortest_path_tree(0, ws);
+        next = NodeId(std::max_element(tree.distance.begin(),
+                                       tree.distance.end(),
+                                       [](double a, double b) {
+                                           // Unreachable nodes count as near
+                                           return (a == infinity ? -1 : a) <
+                                                  (b == infinity ? -1 : b);
+                                       }) -
+                      tree.distance.begin());
+    }
+    for (unsigned i = 0; i < count; i++) {
+        picked.push_back(next);
+        ShortestPathTree tree = g.shortest_path_tree(next, ws);
+        for (NodeId v = 0; v < n; v++) {
+            table[std::size_t{v} * count + i] = tree.distance[v];
+            nearest[v] = std::min(nearest[v], tree.distance[v]);
+        }
+        // Nodes not connected to any landmark yet are farthest of all, so
+        // every component gets one before any gets a second.
+        next = NodeId(std::max_element(nearest.begin(), nearest.end()) -
+                      nearest.begin());
+    }
+
+    nodes = std::move(picked);
+    distances = std::move(table);
+}
+
+LandmarkHeuristic::LandmarkHeuristic(const Graph &g,
+                                     std::shared_ptr<const void> storage)
+    : g{g}, revision{g.revision()}, storage{std::move(storage)} {}
+
+double LandmarkHeuristic::estimate(NodeId from, NodeId to) const {
+    std::size_t count = nodes.size();
+    const double *d_from = distances.data() + std::size_t{from} * count;
+    const double *d_to = distances.data() + std::size_t{to} * count;
+    double best = 0.0;
+    for (std::size_t i = 0; i < count; i++) {
+        // A landmark in another component of either node bounds nothing.
+        if (d_from[i] != infinity && d_to[i] != infinity) {
+            best = std::max(best, std::abs(d_to[i] - d_from[i]));
+        }
+    }
+    return best;
+}
+
+void LandmarkHeuristic::check_current() const {
+    if (g.revision() != revision) {
+        throw std::logic_error{"landmarks are out of date"};
+    }
+}
+
+const Graph &LandmarkHeuristic::graph() const {
+    return g;
+}
+
+const Array<NodeId> &LandmarkHeuristic::landmarks() const {
+    return nodes;
+}
+
+} // namespace graphd
@@ -0,0 +1,131 @@
+#include <graphd/input/load.hpp>
+#include <graphd/input/parse.hpp>
+#include <graphd/pool.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace graphd::input {
+
+/**
+ * Offset of the first character after "[strict] graph [name] {", or nothing
+ * if the input does not start that way. The graph's name is put in name.
+ */
+static std::optional<std::size_t> read_header(std::string_view input,
+                                              std::string &name) {
+    Tokenizer tok{input};
+    Token t = tok.next_token();
+    if (t.type == TokenType::KEYWORD && t.value == "strict") {
+        t = tok.next_token();
+    }
+    if (t.type != TokenType::KEYWORD || t.value != "graph") {
+        return std::nullopt;
+    }
+    t = tok.next_token();
+    if (t.is_identifier()) {
+        name = t.value;
+        t = tok.next_token();
+    }
+    if (t.type != TokenType::OPENING_BRACE) {
+        return std::nullopt;
+    }
+    return tok.position();
+}
+
+/**
+ * Split the statements in body into chunks of about chunk_size bytes. Splits
+ * are made after semicolons outside quoted strings and attribute lists, and
+ * the chunk ending in the closing brace of the graph is cut short before it.
+ * Nothing is returned if the body does not end in that brace.
+ */
+static std::vector<std::string_view> split(std::string_view body,
+                                           std::size_t chunk_size) {
+    std::vector<std::string_view> chunks;
+    std::size_t start = 0;
+    std::size_t end = std::string_view::npos;
+    bool quoted = false;
+    int depth = 0;
+    for (std::size_t i = 0; i < body.size(); i++) {
+        char c = body[i];
+        if (quoted) {
+            if (c == '\\') {
+                i++;
+            } else if (c == '"') {
+                quoted = false;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == '[') {
+            depth++;
+        } else if (c == ']') {
+            depth--;
+        } else if (c == ';' && depth == 0 && i + 1 - start >= chunk_size) {
+            chunks.push_back(body.substr(start, i + 1 - start));
+            start = i + 1;
+        } else if (c == '}' && depth == 0) {
+            end = i;
+            break;
+        }
+    }
+    if (end == std::string_view::npos ||
+        body.find_first_not_of(" \t\r\n", end + 1) != std::string_view::npos) {
+        return {};
+    }
+    chunks.push_back(body.substr(start, end - start));
+    return chunks;
+}
+
+ParseCounters parse_parallel(std::string_view input, Graph &g,
+                             unsigned threads, std::size_t min_chunk_size) {
+    auto parse_serially = [&input, &g]() {
+        Parser p = Parser::of(input);
+        p.parse_into(g);
+        return p.counters();
+    };
+    if (threads < 2 || input.size() < 2 * min_chunk_size) {
+        return parse_serially();
+    }
+
+    std::vector<std::string_view> chunks;
+    std::string name;
+    if (auto start = read_header(input, name); start.has_value()) {
+        std::size_t chunk_size = (input.size() - *start) / threads;
+        chunks = split(input.substr(*start),
+                       std::max(chunk_size, min_chunk_size));
+    }
+    if (chunks.size() < 2) {
+        return parse_serially();
+    }
+
+    ThreadPool pool{threads};
+    std::vector<Graph> parts(chunks.size());
+    std::vector<ParseCounters> counters(chunks.size());
+    for (std::size_t i = 0; i < chunks.size(); i++) {
+        pool.submit([&chunks, &parts, &counters, i](unsigned) {
+            Parser p = Parser::of(chunks[i]);
+            p.parse_statements_into(parts[i]);
+            counters[i] = p.counters();
+        });
+    }
+    try {
+        pool.wait();
+    } catch (const std::exception &) {
+        // The first error in the input is the one to report, along with
+        // whatever precedes it.
+        return parse_serially();
+    }
+
+    g.set_name(std::move(name));
+    g.merge(std::move(parts), pool);
+    ParseCounters total;
+    for (const ParseCounters &c : counters) {
+        total += c;
+    }
+    return total;
+}
+
+} // namespace graphd::input
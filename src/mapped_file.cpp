@@ -0,0 +1,61 @@
+#include <graphd/mapped_file.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace graphd {
+
+static std::runtime_error os_error(const std::string &what,
+                                   const std::string &path) {
+    return std::runtime_error{what + ": " + path + ": " + std::strerror(errno)};
+}
+
+MappedFile::MappedFile(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw os_error("cannot open file", path);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        auto e = os_error("cannot stat file", path);
+        close(fd);
+        throw e;
+    }
+
+    len = st.st_size;
+    // Mapping zero bytes is an error, an empty file simply has no data.
+    if (len > 0) {
+        void *p = mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            auto e = os_error("cannot map file", path);
+            close(fd);
+            throw e;
+        }
+        addr = static_cast<const char *>(p);
+    }
+    // The mapping stays valid without the descriptor.
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (addr != nullptr) {
+        munmap(const_cast<char *>(addr), len);
+    }
+}
+
+const char *MappedFile::data() const {
+    return addr;
+}
+
+std::size_t MappedFile::size() const {
+    return len;
+}
+
+} // namespace graphd
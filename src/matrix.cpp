@@ -0,0 +1,36 @@
+#include <graphd/matrix.hpp>
+#include <graphd/workspace.hpp>
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+namespace graphd {
+
+DistanceMatrix::DistanceMatrix(std::size_t rows, std::size_t columns)
+    : row_count{rows}, column_count{columns},
+      distances(rows * columns, infinity) {}
+
+void DistanceMatrix::write_binary(std::ostream &out) const {
+    std::uint64_t shape[] = {row_count, column_count};
+    out.write(reinterpret_cast<const char *>(shape), sizeof(shape));
+    out.write(reinterpret_cast<const char *>(distances.data()),
+              distances.size() * sizeof(double));
+}
+
+void DistanceMatrix::write_text(std::ostream &out) const {
+    std::ostringstream line;
+    for (std::size_t row = 0; row < row_count; row++) {
+        line.str("");
+        for (std::size_t column = 0; column < column_count; column++) {
+            if (column > 0) {
+                line << '\t';
+            }
+            line << at(row, column);
+        }
+        line << '\n';
+        out << line.str();
+    }
+}
+
+} // namespace graphd
@@ -1,70 +1,373 @@
 #include <graphd/input/parse.hpp>
 #include <graphd/input/parser/expr.hpp>
-#include <graphd/input/parser/reduce.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
 #include <utility>
 
-namespace graphd::input {
+/*
+ * The grammar, numbered by rule. Rule 0 is the start rule, completing it
+ * means accepting the input.
+ *
+ *  0  start -> graph END
+ *  1  graph -> GRAPH name '{' stmts '}'
+ *  2  graph -> STRICT GRAPH name '{' stmts '}'
+ *  3  name  -> (empty)
+ *  4  name  -> ID
+ *  5  stmts -> (empty)
+ *  6  stmts -> stmts stmt
+ *  7  stmt  -> ID '--' ID attrs ';'
+ *  8  stmt  -> ID attrs ';'
+ *  9  attrs -> (empty)
+ * 10  attrs -> '[' alist ']'
+ * 11  alist -> attr
+ * 12  alist -> alist attr
+ * 13  attr  -> ID '=' ID
+ * 14  attr  -> ',' ID '=' ID
+ *
+ * The tables below are the SLR(1) automaton for this grammar. Changes to the
+ * grammar require building the automaton anew, following any compiler
+ * textbook.
+ */
+namespace graphd::input::lr {
 
-Expression *Parser::parse() {
-    while (shift()) {
-        while (reduce()) {
-            // keep reducing
-        }
+enum Terminal : std::uint8_t {
+    STRICT,
+    GRAPH,
+    ID,
+    EDGE_OP,
+    LBRACE,
+    RBRACE,
+    LBRACKET,
+    RBRACKET,
+    EQUALS,
+    SEMICOLON,
+    COMMA,
+    END,
+    NUMBER_OF_TERMINALS,
+};
+
+enum Nonterminal : std::uint8_t {
+    GRAPH_DEF,
+    NAME,
+    STMTS,
+    STMT,
+    ATTRS,
+    ALIST,
+    ATTR,
+    NUMBER_OF_NONTERMINALS,
+};
+
+enum class Kind : std::uint8_t { ERROR, SHIFT, REDUCE, ACCEPT };
+
+/**
+ * What to do in a state on a given lookahead: shift and enter the given
+ * state, or reduce by the given rule.
+ */
+struct Action {
+    Kind kind;
+    std::uint8_t arg;
+};
+
+static constexpr Action s(std::uint8_t state) {
+    return Action{Kind::SHIFT, state};
+}
+static constexpr Action r(std::uint8_t rule) {
+    return Action{Kind::REDUCE, rule};
+}
+static constexpr Action acc{Kind::ACCEPT, 0};
+static constexpr Action __{Kind::ERROR, 0};
+
+struct Rule {
+    Nonterminal lhs;
+    std::uint8_t length;
+};
+
+static constexpr Rule rules[] = {
+    {GRAPH_DEF, 1}, {GRAPH_DEF, 5}, {GRAPH_DEF, 6}, {NAME, 0}, {NAME, 1},
+    {STMTS, 0},     {STMTS, 2},     {STMT, 5},      {STMT, 3}, {ATTRS, 0},
+    {ATTRS, 3},     {ALIST, 1},     {ALIST, 2},     {ATTR, 3}, {ATTR, 4},
+};
+
+static constexpr int number_of_states = 34;
+
+// clang-format off
+static constexpr Action actions[number_of_states][NUMBER_OF_TERMINALS] = {
+    //        STRICT GRAPH ID   '--'  '{'   '}'    '['    ']'    '='    ';'    ','    END
+    /*  0 */ {s(1), s(2), __,    __,    __,   __,    __,    __,    __,    __,    __,    __},
+    /*  1 */ {__,   s(4), __,    __,    __,   __,    __,    __,    __,    __,    __,    __},
+    /*  2 */ {__,   __,   s(5),  __,    r(3), __,    __,    __,    __,    __,    __,    __},
+    /*  3 */ {__,   __,   __,    __,    __,   __,    __,    __,    __,    __,    __,    acc},
+    /*  4 */ {__,   __,   s(5),  __,    r(3), __,    __,    __,    __,    __,    __,    __},
+    /*  5 */ {__,   __,   __,    __,    r(4), __,    __,    __,    __,    __,    __,    __},
+    /*  6 */ {__,   __,   __,    __,    s(8), __,    __,    __,    __,    __,    __,    __},
+    /*  7 */ {__,   __,   __,    __,    s(9), __,    __,    __,    __,    __,    __,    __},
+    /*  8 */ {__,   __,   r(5),  __,    __,   r(5),  __,    __,    __,    __,    __,    __},
+    /*  9 */ {__,   __,   r(5),  __,    __,   r(5),  __,    __,    __,    __,    __,    __},
+    /* 10 */ {__,   __,   s(12), __,    __,   s(13), __,    __,    __,    __,    __,    __},
+    /* 11 */ {__,   __,   s(12), __,    __,   s(15), __,    __,    __,    __,    __,    __},
+    /* 12 */ {__,   __,   __,    s(16), __,   __,    s(17), __,    __,    r(9),  __,    __},
+    /* 13 */ {__,   __,   __,    __,    __,   __,    __,    __,    __,    __,    __,    r(1)},
+    /* 14 */ {__,   __,   r(6),  __,    __,   r(6),  __,    __,    __,    __,    __,    __},
+    /* 15 */ {__,   __,   __,    __,    __,   __,    __,    __,    __,    __,    __,    r(2)},
+    /* 16 */ {__,   __,   s(19), __,    __,   __,    __,    __,    __,    __,    __,    __},
+    /* 17 */ {__,   __,   s(20), __,    __,   __,    __,    __,    __,    __,    s(21), __},
+    /* 18 */ {__,   __,   __,    __,    __,   __,    __,    __,    __,    s(24), __,    __},
+    /* 19 */ {__,   __,   __,    __,    __,   __,    s(17), __,    __,    r(9),  __,    __},
+    /* 20 */ {__,   __,   __,    __,    __,   __,    __,    __,    s(26), __,    __,    __},
+    /* 21 */ {__,   __,   s(27), __,    __,   __,    __,    __,    __,    __,    __,    __},
+    /* 22 */ {__,   __,   s(20), __,    __,   __,    __,    s(28), __,    __,    s(21), __},
+    /* 23 */ {__,   __,   r(11), __,    __,   __,    __,    r(11), __,    __,    r(11), __},
+    /* 24 */ {__,   __,   r(8),  __,    __,   r(8),  __,    __,    __,    __,    __,    __},
+    /* 25 */ {__,   __,   __,    __,    __,   __,    __,    __,    __,    s(30), __,    __},
+    /* 26 */ {__,   __,   s(31), __,    __,   __,    __,    __,    __,    __,    __,    __},
+    /* 27 */ {__,   __,   __,    __,    __,   __,    __,    __,    s(32), __,    __,    __},
+    /* 28 */ {__,   __,   __,    __,    __,   __,    __,    __,    __,    r(10), __,    __},
+    /* 29 */ {__,   __,   r(12), __,    __,   __,    __,    r(12), __,    __,    r(12), __},
+    /* 30 */ {__,   __,   r(7),  __,    __,   r(7),  __,    __,    __,    __,    __,    __},
+    /* 31 */ {__,   __,   r(13), __,    __,   __,    __,    r(13), __,    __,    r(13), __},
+    /* 32 */ {__,   __,   s(33), __,    __,   __,    __,    __,    __,    __,    __,    __},
+    /* 33 */ {__,   __,   r(14), __,    __,   __,    __,    r(14), __,    __,    r(14), __},
+};
+
+// State to enter after reducing to a nonterminal. Zero where unreachable.
+static constexpr std::uint8_t gotos[number_of_states][NUMBER_OF_NONTERMINALS] = {
+    //        graph name stmts stmt attrs alist attr
+    /*  0 */ {3,    0,   0,    0,   0,    0,    0},
+    /*  1 */ {0,    0,   0,    0,   0,    0,    0},
+    /*  2 */ {0,    6,   0,    0,   0,    0,    0},
+    /*  3 */ {0,    0,   0,    0,   0,    0,    0},
+    /*  4 */ {0,    7,   0,    0,   0,    0,    0},
+    /*  5 */ {0,    0,   0,    0,   0,    0,    0},
+    /*  6 */ {0,    0,   0,    0,   0,    0,    0},
+    /*  7 */ {0,    0,   0,    0,   0,    0,    0},
+    /*  8 */ {0,    0,   10,   0,   0,    0,    0},
+    /*  9 */ {0,    0,   11,   0,   0,    0,    0},
+    /* 10 */ {0,    0,   0,    14,  0,    0,    0},
+    /* 11 */ {0,    0,   0,    14,  0,    0,    0},
+    /* 12 */ {0,    0,   0,    0,   18,   0,    0},
+    /* 13 */ {0,    0,   0,    0,   0,    0,    0},
+    /* 14 */ {0,    0,   0,    0,   0,    0,    0},
+    /* 15 */ {0,    0,   0,    0,   0,    0,    0},
+    /* 16 */ {0,    0,   0,    0,   0,    0,    0},
+    /* 17 */ {0,    0,   0,    0,   0,    22,   23},
+    /* 18 */ {0,    0,   0,    0,   0,    0,    0},
+    /* 19 */ {0,    0,   0,    0,   25,   0,    0},
+    /* 20 */ {0,    0,   0,    0,   0,    0,    0},
+    /* 21 */ {0,    0,   0,    0,   0,    0,    0},
+    /* 22 */ {0,    0,   0,    0,   0,    0,    29},
+    /* 23 */ {0,    0,   0,    0,   0,    0,    0},
+    /* 24 */ {0,    0,   0,    0,   0,    0,    0},
+    /* 25 */ {0,    0,   0,    0,   0,    0,    0},
+    /* 26 */ {0,    0,   0,    0,   0,    0,    0},
+    /* 27 */ {0,    0,   0,    0,   0,    0,    0},
+    /* 28 */ {0,    0,   0,    0,   0,    0,    0},
+    /* 29 */ {0,    0,   0,    0,   0,    0,    0},
+    /* 30 */ {0,    0,   0,    0,   0,    0,    0},
+    /* 31 */ {0,    0,   0,    0,   0,    0,    0},
+    /* 32 */ {0,    0,   0,    0,   0,    0,    0},
+    /* 33 */ {0,    0,   0,    0,   0,    0,    0},
+};
+// clang-format on
+
+static Terminal terminal(const Token &t) {
+    switch (t.type) {
+    case TokenType::KEYWORD:
+        return t.value == "strict" ? STRICT : GRAPH;
+    case TokenType::NAME:
+    case TokenType::NUMERAL:
+        return ID;
+    case TokenType::UNDIRECTED_EDGE:
+        return EDGE_OP;
+    case TokenType::OPENING_BRACE:
+        return LBRACE;
+    case TokenType::CLOSING_BRACE:
+        return RBRACE;
+    case TokenType::OPENING_SQUARE_BRACKET:
+        return LBRACKET;
+    case TokenType::CLOSING_SQUARE_BRACKET:
+        return RBRACKET;
+    case TokenType::EQUAL_SIGN:
+        return EQUALS;
+    case TokenType::SEMICOLON:
+        return SEMICOLON;
+    case TokenType::COMMA:
+        return COMMA;
+    case TokenType::EOI:
+        return END;
+    default:
+        throw std::runtime_error{"unsupported token: " +
+                                 std::string{t.value}};
     }
+}
+
+} // namespace graphd::input::lr
 
-    if (stack.size() != 1) {
-        throw std::runtime_error{
-            "input must contain exactly one full graph definition"};
+namespace graphd::input {
+
+static std::runtime_error syntax_error(const Token &t) {
+    if (t.type == TokenType::EOI) {
+        return std::runtime_error{"syntax error: unexpected end of input"};
     }
+    return std::runtime_error{"syntax error: unexpected '" +
+                              std::string{t.value} + "'"};
+}
 
-    Expression *ret = stack.front();
-    stack.clear();
-    return ret;
+Expression *Parser::parse() {
+    sink = nullptr;
+    return run();
+}
+
+void Parser::parse_into(Graph &g) {
+    sink = &g;
+    run()->apply_to_graph(g);
+}
+
+void Parser::parse_statements_into(Graph &g) {
+    sink = &g;
+    // The states after reading "graph {".
+    stack.push_back(StackEntry{0, Token{TokenType::EOI, ""}, nullptr});
+    stack.push_back(StackEntry{2, Token::from("graph"), nullptr});
+    stack.push_back(StackEntry{6, Token{TokenType::NAME, ""}, nullptr});
+    stack.push_back(StackEntry{8, Token::from('{'), nullptr});
+    run(true);
 }
 
-bool Parser::shift() {
-    if (lookahead.type == TokenType::EOI) {
-        return false;
+Expression *Parser::run(bool fragment) {
+    if (stack.empty()) {
+        stack.push_back(StackEntry{0, Token{TokenType::EOI, ""}, nullptr});
     }
+    auto next_token = [this, &fragment]() {
+        Token t = tok.next_token();
+        GRAPHD_COUNT(parse_counters.tokens++;)
+        if (t.type == TokenType::EOI && fragment) {
+            fragment = false;
+            return Token::from('}');
+        }
+        return t;
+    };
+    Token lookahead = next_token();
 
-    stack.push_back(new expr::TokenExpr{lookahead});
-    lookahead = tok.next_token();
-    return true;
+    while (true) {
+        lr::Action a = lr::actions[stack.back().state][lr::terminal(lookahead)];
+        switch (a.kind) {
+        case lr::Kind::SHIFT:
+            stack.push_back(StackEntry{a.arg, lookahead, nullptr});
+            GRAPHD_COUNT(parse_counters.max_stack_depth = std::max(
+                             parse_counters.max_stack_depth, stack.size());)
+            lookahead = next_token();
+            break;
+        case lr::Kind::REDUCE: {
+            StackEntry lhs = reduce(a.arg);
+            stack.resize(stack.size() - lr::rules[a.arg].length);
+            lhs.state = lr::gotos[stack.back().state][lr::rules[a.arg].lhs];
+            stack.push_back(lhs);
+            break;
+        }
+        case lr::Kind::ACCEPT: {
+            Expression *graph = stack.back().expr;
+            stack.clear();
+            return graph;
+        }
+        case lr::Kind::ERROR:
+            throw syntax_error(lookahead);
+        }
+    }
 }
 
-bool Parser::reduce() {
-    bool performed = false;
-    for (auto red : reductions) {
-        if (red->perform(lookahead, stack)) {
-            performed = true;
+Parser::StackEntry Parser::reduce(int rule) {
+    // Values of the symbols on the right-hand side, v(0) being the first.
+    std::size_t base = stack.size() - lr::rules[rule].length;
+    auto v = [this, base](std::size_t i) -> StackEntry & {
+        return stack[base + i];
+    };
+    auto str = [&v](std::size_t i) { return v(i).token.value; };
+
+    StackEntry lhs{0, Token{TokenType::EOI, ""}, nullptr};
+    switch (rule) {
+    case 1:
+        lhs.expr = tree.create<expr::FullGraph>(
+            str(1), static_cast<expr::StmtList *>(v(3).expr));
+        break;
+    case 2:
+        lhs.expr = tree.create<expr::FullGraph>(
+            str(2), static_cast<expr::StmtList *>(v(4).expr));
+        break;
+    case 3:
+        lhs.token = Token{TokenType::NAME, ""};
+        break;
+    case 4:
+        lhs.token = v(0).token;
+        break;
+    case 5:
+        lhs.expr = tree.create<expr::StmtList>(tree.resource());
+        break;
+    case 6: {
+        auto list = static_cast<expr::StmtList *>(v(0).expr);
+        list->add_statement(static_cast<expr::Statement *>(v(1).expr));
+        if (sink != nullptr) {
+            GRAPHD_COUNT(auto start = std::chrono::steady_clock::now();)
+            list->flush_into(*sink);
+            GRAPHD_COUNT(parse_counters.statement_ms +=
+                         std::chrono::duration<double, std::milli>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();)
+            // Nothing else on the stack is allocated there.
+            statements.release();
         }
+        lhs.expr = list;
+        break;
+    }
+    case 7:
+        lhs.expr = statements.create<expr::EdgeStmt>(
+            str(0), str(2), static_cast<expr::AttributeList *>(v(3).expr));
+        break;
+    case 8:
+        lhs.expr = statements.create<expr::NodeStmt>(
+            str(0), static_cast<expr::AttributeList *>(v(1).expr));
+        break;
+    case 9:
+        break;
+    case 10: {
+        auto alist = static_cast<expr::AList *>(v(1).expr);
+        lhs.expr = alist->as_attr_list(statements);
+        break;
+    }
+    case 11: {
+        auto alist =
+            statements.create<expr::AList>(statements.resource());
+        alist->add_attribute(static_cast<expr::Attribute *>(v(0).expr));
+        lhs.expr = alist;
+        break;
+    }
+    case 12: {
+        auto alist = static_cast<expr::AList *>(v(0).expr);
+        alist->add_attribute(static_cast<expr::Attribute *>(v(1).expr));
+        lhs.expr = alist;
+        break;
+    }
+    case 13:
+        lhs.expr = statements.create<expr::Attribute>(str(0), str(2));
+        break;
+    case 14:
+        lhs.expr = statements.create<expr::Attribute>(str(1), str(3));
+        break;
+    default:
+        throw std::logic_error{"no such rule: " + std::to_string(rule)};
     }
-    return performed;
+    return lhs;
 }
 
 Parser Parser::of(std::istream &in) {
-    Tokenizer tok{in};
-    Token next = tok.next_token();
-    auto reductions = std::vector<Reduction *>{
-        new reduce::ToStatement, new reduce::ToStmtList,
-        new reduce::ToGraph,     new reduce::ToAttribute,
-        new reduce::ToAList,     new reduce::ToAttrList};
-    return Parser{tok, next, reductions};
+    return Parser{Tokenizer{in}};
 }
 
-Parser::Parser(Tokenizer tokenizer, Token first_token,
-               std::vector<Reduction *> reductions)
-    : stack{}, lookahead{first_token}, tok{tokenizer}, reductions{reductions} {}
-
-Parser::~Parser() {
-    for (auto red : reductions) {
-        delete red;
-    }
-
-    for (auto ex : stack) {
-        delete ex;
-    }
+Parser Parser::of(std::string_view input) {
+    return Parser{Tokenizer{input}};
 }
 
+Parser::Parser(Tokenizer tokenizer) : tok{std::move(tokenizer)} {}
+
 } // namespace graphd::input
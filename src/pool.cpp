@@ -0,0 +1,81 @@
+#include <graphd/pool.hpp>
+
+#include <stdexcept>
+#include <utility>
+
+namespace graphd {
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) {
+        throw std::invalid_argument{"thread pool needs at least one thread"};
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        workers.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stopping = true;
+    }
+    task_ready.notify_all();
+    for (auto &t : workers) {
+        t.join();
+    }
+}
+
+unsigned ThreadPool::size() const {
+    return workers.size();
+}
+
+void ThreadPool::submit(Task task) {
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        tasks.push_back(std::move(task));
+        pending++;
+    }
+    task_ready.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock{mutex};
+    all_done.wait(lock, [this] { return pending == 0; });
+    if (failure) {
+        std::exception_ptr e = failure;
+        failure = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+void ThreadPool::work(unsigned worker) {
+    std::unique_lock<std::mutex> lock{mutex};
+    while (true) {
+        task_ready.wait(lock, [this] { return stopping || !tasks.empty(); });
+        if (tasks.empty()) {
+            // stopping
+            return;
+        }
+
+        Task task = std::move(tasks.front());
+        tasks.pop_front();
+        lock.unlock();
+
+        std::exception_ptr error;
+        try {
+            task(worker);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        if (error && !failure) {
+            failure = error;
+        }
+        if (--pending == 0) {
+            all_done.notify_all();
+        }
+    }
+}
+
+} // namespace graphd
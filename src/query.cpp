@@ -0,0 +1,243 @@
+#include <graphd/matrix.hpp>
+#include <graphd/pool.hpp>
+#include <graphd/query.hpp>
+#include <graphd/workspace.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graphd {
+
+// Output is handed to the stream once the buffer exceeds this size.
+static constexpr std::size_t flush_threshold = 1 << 16;
+// In parallel mode, queries are read in blocks and handed to the workers in
+// chunks of consecutive lines.
+static constexpr std::size_t block_size = 1 << 14;
+static constexpr std::size_t chunk_size = 256;
+
+static bool is_blank(char c) {
+    return std::isspace(static_cast<unsigned char>(c));
+}
+
+Algorithm parse_algorithm(const std::string &name) {
+    if (name == "dijkstra") {
+        return Algorithm::DIJKSTRA;
+    }
+    if (name == "bidirectional") {
+        return Algorithm::BIDIRECTIONAL;
+    }
+    if (name == "astar") {
+        return Algorithm::ASTAR;
+    }
+    throw std::runtime_error{"unknown algorithm: " + name};
+}
+
+static std::vector<std::string> split_words(const std::string &line) {
+    std::vector<std::string> words;
+    std::size_t i = 0;
+    while (i < line.size()) {
+        while (i < line.size() && is_blank(line[i])) {
+            i++;
+        }
+        std::size_t start = i;
+        while (i < line.size() && !is_blank(line[i])) {
+            i++;
+        }
+        if (i > start) {
+            words.emplace_back(line, start, i - start);
+        }
+    }
+    return words;
+}
+
+std::optional<Query> parse_query(const std::string &line) {
+    std::vector<std::string> words = split_words(line);
+    if (words.empty()) {
+        return std::nullopt;
+    }
+    if (words.size() != 2) {
+        throw std::runtime_error{"malformed query: " + line};
+    }
+    return Query{words[0], words[1]};
+}
+
+std::vector<NodeName> read_nodes(std::istream &in) {
+    std::vector<NodeName> nodes;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::vector<std::string> words = split_words(line);
+        if (words.size() > 1) {
+            throw std::runtime_error{"malformed node list entry: " + line};
+        }
+        if (!words.empty()) {
+            nodes.push_back(std::move(words[0]));
+        }
+    }
+    return nodes;
+}
+
+void format_path(std::string &out, const Path &p) {
+    std::ostringstream dist;
+    dist << p.total_distance;
+    out += dist.str();
+    out += '\t';
+    out += p.nodes[0];
+    for (std::size_t i = 1; i < p.nodes.size(); i++) {
+        out += " -> ";
+        out += p.nodes[i];
+    }
+    out += '\n';
+}
+
+void format_error(std::string &out, const std::string &msg) {
+    out += "error: ";
+    out += msg;
+    out += '\n';
+}
+
+void write_tree(const Graph &g, const ShortestPathTree &tree,
+                std::ostream &out) {
+    std::string buffer;
+    std::ostringstream dist;
+    for (NodeId n = 0; n < tree.distance.size(); n++) {
+        if (tree.distance[n] == infinity) {
+            continue;
+        }
+        buffer += g.name_of(n);
+        buffer += '\t';
+        dist.str("");
+        dist << tree.distance[n];
+        buffer += dist.str();
+        buffer += '\t';
+        if (tree.predecessor[n] != no_node) {
+            buffer += g.name_of(tree.predecessor[n]);
+        }
+        buffer += '\n';
+        if (buffer.size() >= flush_threshold) {
+            out << buffer;
+            buffer.clear();
+        }
+    }
+    out << buffer;
+}
+
+static Path search(const Graph &g, const Query &q, SearchWorkspace &ws,
+                   const BatchOptions &options) {
+    if (options.hierarchy) {
+        return options.hierarchy->shortest_path(q.from, q.to, ws);
+    }
+    if (options.heuristic) {
+        return g.shortest_path(q.from, q.to, ws, *options.heuristic);
+    }
+    return g.shortest_path(q.from, q.to, ws, options.algorithm);
+}
+
+Path answer_query(const Graph &g, const Query &q, SearchWorkspace &ws,
+                  const BatchOptions &options) {
+    if (!options.cache) {
+        return search(g, q, ws, options);
+    }
+    if (auto hit = options.cache->find(q.from, q.to); hit.has_value()) {
+        return std::move(hit.value());
+    }
+    Path p = search(g, q, ws, options);
+    options.cache->insert(q.from, q.to, p);
+    return p;
+}
+
+DistanceMatrix answer_matrix(const Graph &g,
+                             const std::vector<NodeName> &sources,
+                             const std::vector<NodeName> &targets,
+                             const BatchOptions &options) {
+    if (options.hierarchy) {
+        return options.hierarchy->distance_matrix(sources, targets,
+                                                  options.threads);
+    }
+    return g.distance_matrix(sources, targets, options.threads);
+}
+
+void answer_line(const Graph &g, const std::string &line, SearchWorkspace &ws,
+                 const BatchOptions &options, std::string &out) {
+    try {
+        if (auto q = parse_query(line); q.has_value()) {
+            format_path(out, answer_query(g, q.value(), ws, options));
+        }
+    } catch (const std::runtime_error &e) {
+        // Report the failure in place, so output stays aligned with input.
+        format_error(out, e.what());
+    }
+}
+
+static void run_sequential(const Graph &g, std::istream &in,
+                           std::ostream &out, const BatchOptions &options) {
+    SearchWorkspace ws;
+    std::string buffer;
+    std::string line;
+
+    while (std::getline(in, line)) {
+        answer_line(g, line, ws, options, buffer);
+        if (buffer.size() >= flush_threshold) {
+            out << buffer;
+            buffer.clear();
+        }
+    }
+
+    out << buffer;
+    if (options.counters != nullptr) {
+        *options.counters += ws.counters();
+    }
+}
+
+static void run_parallel(const Graph &g, std::istream &in, std::ostream &out,
+                         const BatchOptions &options) {
+    ThreadPool pool{options.threads};
+    std::vector<SearchWorkspace> workspaces(options.threads);
+    std::vector<std::string> lines(block_size);
+    std::vector<std::string> chunks;
+
+    while (in) {
+        std::size_t count = 0;
+        while (count < block_size && std::getline(in, lines[count])) {
+            count++;
+        }
+
+        std::size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+        chunks.assign(chunk_count, "");
+        for (std::size_t c = 0; c < chunk_count; c++) {
+            pool.submit([&, c](unsigned worker) {
+                std::size_t end = std::min(count, (c + 1) * chunk_size);
+                for (std::size_t i = c * chunk_size; i < end; i++) {
+                    answer_line(g, lines[i], workspaces[worker], options,
+                                chunks[c]);
+                }
+            });
+        }
+        pool.wait();
+
+        for (auto &chunk : chunks) {
+            out << chunk;
+        }
+    }
+
+    if (options.counters != nullptr) {
+        for (const SearchWorkspace &ws : workspaces) {
+            *options.counters += ws.counters();
+        }
+    }
+}
+
+void run_batch(const Graph &g, std::istream &in, std::ostream &out,
+               const BatchOptions &options) {
+    if (options.threads > 1) {
+        run_parallel(g, in, out, options);
+    } else {
+        run_sequential(g, in, out, options);
+    }
+    out.flush();
+}
+
+} // namespace graphd
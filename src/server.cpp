@@ -0,0 +1,396 @@
+#include <graphd/server.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace graphd {
+
+// Epoll keys of the two descriptors that are not connections
+constexpr std::uint64_t listener_key = ~std::uint64_t{0};
+constexpr std::uint64_t wakeup_key = listener_key - 1;
+
+// Lines longer than this are not queries; the connection is dropped.
+constexpr std::size_t max_line = 1 << 20;
+// Stop answering a client's queries while it does not read this much.
+constexpr std::size_t max_pending_output = 1 << 20;
+
+static std::runtime_error os_error(const std::string &what,
+                                   const std::string &path) {
+    return std::runtime_error{what + ": " + path + ": " + std::strerror(errno)};
+}
+
+static void watch(int poller, int fd, std::uint64_t key, std::uint32_t events,
+                  int op = EPOLL_CTL_ADD) {
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.u64 = key;
+    if (epoll_ctl(poller, op, fd, &ev) != 0) {
+        throw std::runtime_error{std::string{"cannot watch socket: "} +
+                                 std::strerror(errno)};
+    }
+}
+
+/**
+ * Whether a server still listens on the socket at addr. Only a refused
+ * connection tells that the socket is stale.
+ */
+static bool in_use(const sockaddr_un &addr) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return true;
+    }
+    bool refused =
+        connect(fd, reinterpret_cast<const sockaddr *>(&addr),
+                sizeof(addr)) != 0 &&
+        errno == ECONNREFUSED;
+    close(fd);
+    return !refused;
+}
+
+Server::Server(const Graph &g, const std::string &path,
+               const BatchOptions &options)
+    : Server{ServedGraph{&g, options, nullptr}, path} {}
+
+Server::Server(ServedGraph graph, const std::string &path,
+               std::function<ServedGraph()> load)
+    : current{std::make_shared<const ServedGraph>(std::move(graph))},
+      load{std::move(load)}, path{path},
+      workspaces(current->options.threads), pool{current->options.threads} {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error{"socket path too long: " + path};
+    }
+    std::strcpy(addr.sun_path, path.c_str());
+
+    try {
+        listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                          0);
+        if (listener < 0) {
+            throw os_error("cannot create socket", path);
+        }
+        // A socket file outlives the server that created it. One another
+        // server still listens on is not taken over, and anything else at
+        // path is left alone, so that bind fails.
+        struct stat st;
+        if (lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+            if (in_use(addr)) {
+                throw std::runtime_error{"socket in use: " + path};
+            }
+            unlink(path.c_str());
+        }
+        if (bind(listener, reinterpret_cast<sockaddr *>(&addr),
+                 sizeof(addr)) != 0) {
+            throw os_error("cannot bind socket", path);
+        }
+        if (listen(listener, SOMAXCONN) != 0) {
+            throw os_error("cannot listen on socket", path);
+        }
+
+        poller = epoll_create1(EPOLL_CLOEXEC);
+        wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (poller < 0 || wakeup < 0) {
+            throw os_error("cannot set up event loop for socket", path);
+        }
+        watch(poller, listener, listener_key, EPOLLIN);
+        watch(poller, wakeup, wakeup_key, EPOLLIN);
+    } catch (...) {
+        for (int fd : {listener, poller, wakeup}) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+        throw;
+    }
+}
+
+Server::~Server() {
+    // Workers and the loader report to wakeup, it must not be closed under
+    // them.
+    if (loader.joinable()) {
+        loader.join();
+    }
+    try {
+        pool.wait();
+    } catch (...) {
+        // Batches catch their own errors, there is nothing to report.
+    }
+    for (auto &[id, c] : connections) {
+        close(c.fd);
+    }
+    close(listener);
+    close(poller);
+    close(wakeup);
+    unlink(path.c_str());
+}
+
+void Server::stop() {
+    stopping = true;
+    std::uint64_t one = 1;
+    // Nothing to do if this fails: the counter is already nonzero then.
+    [[maybe_unused]] auto r = write(wakeup, &one, sizeof(one));
+}
+
+void Server::reload() {
+    reload_requested = true;
+    std::uint64_t one = 1;
+    [[maybe_unused]] auto r = write(wakeup, &one, sizeof(one));
+}
+
+void Server::run() {
+    std::vector<epoll_event> events(64);
+    while (!stopping) {
+        int n = epoll_wait(poller, events.data(), events.size(), -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw os_error("cannot wait for socket", path);
+        }
+
+        for (int i = 0; i < n; i++) {
+            std::uint64_t key = events[i].data.u64;
+            if (key == listener_key) {
+                accept_clients();
+                continue;
+            }
+            if (key == wakeup_key) {
+                std::uint64_t count;
+                [[maybe_unused]] auto r = read(wakeup, &count, sizeof(count));
+                collect();
+                publish();
+                if (reload_requested) {
+                    start_loading();
+                }
+                continue;
+            }
+
+            auto it = connections.find(key);
+            if (it == connections.end()) {
+                continue;
+            }
+            Connection &c = it->second;
+            if (events[i].events & EPOLLIN) {
+                receive(c);
+            }
+            if (events[i].events & EPOLLOUT) {
+                send(c);
+            }
+            if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                // Nothing can be sent anymore.
+                c.failed = true;
+            }
+            dispatch(key, c);
+            update(key, c);
+        }
+    }
+}
+
+void Server::accept_clients() {
+    while (true) {
+        int fd = accept4(listener, nullptr, nullptr,
+                         SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            // Out of descriptors or the like: try again on the next event.
+            return;
+        }
+        std::uint64_t id = next_id++;
+        try {
+            watch(poller, fd, id, EPOLLIN);
+        } catch (const std::runtime_error &) {
+            close(fd);
+            continue;
+        }
+        connections.emplace(id, Connection{fd, {}, {}, EPOLLIN});
+    }
+}
+
+void Server::receive(Connection &c) {
+    char buffer[1 << 16];
+    while (c.in.size() < max_line) {
+        ssize_t r = read(c.fd, buffer, sizeof(buffer));
+        if (r > 0) {
+            c.in.append(buffer, r);
+        } else if (r == 0) {
+            c.eof = true;
+            return;
+        } else if (errno == EINTR) {
+            continue;
+        } else {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                c.failed = true;
+            }
+            return;
+        }
+    }
+}
+
+void Server::send(Connection &c) {
+    std::size_t sent = 0;
+    while (sent < c.out.size()) {
+        ssize_t r = ::send(c.fd, c.out.data() + sent, c.out.size() - sent,
+                           MSG_NOSIGNAL);
+        if (r >= 0) {
+            sent += r;
+        } else if (errno == EINTR) {
+            continue;
+        } else {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                c.failed = true;
+            }
+            break;
+        }
+    }
+    c.out.erase(0, sent);
+}
+
+void Server::dispatch(std::uint64_t id, Connection &c) {
+    if (c.busy || c.failed || c.out.size() >= max_pending_output) {
+        return;
+    }
+    // Answer complete lines only, and the last one once the client is done.
+    // Without a newline, rfind returns npos and end wraps around to 0.
+    std::size_t end = c.eof ? c.in.size() : c.in.rfind('\n') + 1;
+    if (end == 0) {
+        if (c.in.size() >= max_line) {
+            c.failed = true;
+        }
+        return;
+    }
+
+    std::string batch = c.in.substr(0, end);
+    c.in.erase(0, end);
+    c.busy = true;
+    // The batch keeps the graph it started with alive, even if another one
+    // is published meanwhile.
+    pool.submit([this, id, batch = std::move(batch),
+                 served = current](unsigned worker) {
+        std::string out;
+        std::string line;
+        for (std::size_t pos = 0; pos < batch.size();) {
+            std::size_t next = batch.find('\n', pos);
+            if (next == std::string::npos) {
+                next = batch.size();
+            }
+            line.assign(batch, pos, next - pos);
+            try {
+                answer_line(*served->graph, line, workspaces[worker],
+                            served->options, out);
+            } catch (const std::exception &e) {
+                format_error(out, e.what());
+            }
+            pos = next + 1;
+        }
+        {
+            std::lock_guard lock{finished_mutex};
+            finished.emplace_back(id, std::move(out));
+        }
+        std::uint64_t one = 1;
+        [[maybe_unused]] auto r = write(wakeup, &one, sizeof(one));
+    });
+}
+
+void Server::collect() {
+    std::deque<std::pair<std::uint64_t, std::string>> done;
+    {
+        std::lock_guard lock{finished_mutex};
+        done.swap(finished);
+    }
+    for (auto &[id, out] : done) {
+        auto it = connections.find(id);
+        if (it == connections.end()) {
+            // Closed while its queries were being answered
+            continue;
+        }
+        Connection &c = it->second;
+        c.busy = false;
+        c.out += out;
+        send(c);
+        dispatch(id, c);
+        update(id, c);
+    }
+}
+
+void Server::start_loading() {
+    if (!load) {
+        reload_requested = false;
+        return;
+    }
+    if (loader.joinable()) {
+        // Requests made meanwhile are picked up once the load is published.
+        return;
+    }
+    reload_requested = false;
+    loader = std::thread{[this] {
+        std::shared_ptr<const ServedGraph> result;
+        try {
+            result = std::make_shared<const ServedGraph>(load());
+        } catch (...) {
+            // Keep serving the current graph, the loader reports errors.
+        }
+        {
+            std::lock_guard lock{finished_mutex};
+            loaded = std::move(result);
+            load_finished = true;
+        }
+        std::uint64_t one = 1;
+        [[maybe_unused]] auto r = write(wakeup, &one, sizeof(one));
+    }};
+}
+
+void Server::publish() {
+    std::shared_ptr<const ServedGraph> graph;
+    {
+        std::lock_guard lock{finished_mutex};
+        if (!load_finished) {
+            return;
+        }
+        load_finished = false;
+        graph = std::move(loaded);
+    }
+    loader.join();
+    if (graph) {
+        // The old graph goes once the batches still using it finish.
+        current = std::move(graph);
+    }
+}
+
+void Server::update(std::uint64_t id, Connection &c) {
+    bool done = c.eof && !c.busy && c.in.empty() && c.out.empty();
+    if (c.failed || done) {
+        close_connection(id);
+        return;
+    }
+
+    std::uint32_t events = 0;
+    if (!c.eof && c.in.size() < max_line) {
+        events |= EPOLLIN;
+    }
+    if (!c.out.empty()) {
+        events |= EPOLLOUT;
+    }
+    if (events != c.events) {
+        watch(poller, c.fd, id, events, EPOLL_CTL_MOD);
+        c.events = events;
+    }
+}
+
+void Server::close_connection(std::uint64_t id) {
+    auto it = connections.find(id);
+    // Closing the descriptor also removes it from the epoll set.
+    close(it->second.fd);
+    connections.erase(it);
+}
+
+} // namespace graphd
@@ -0,0 +1,304 @@
+#include <graphd/mapped_file.hpp>
+#include <graphd/snapshot.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace graphd {
+
+static constexpr char magic[8] = {'G', 'R', 'A', 'P', 'H', 'D', 'S', 'N'};
+// Bumped for changes existing readers cannot cope with. Adding a section
+// kind is not one of them.
+static constexpr std::uint32_t version = 1;
+// Reads differently on a machine of the other endianness.
+static constexpr std::uint32_t byte_order_mark = 0x01020304;
+static constexpr std::size_t alignment = 8;
+
+enum class SectionKind : std::uint32_t {
+    GRAPH_NAME = 1,
+    NAME_OFFSETS = 2,
+    NAME_CHARS = 3,
+    SORTED_IDS = 4,
+    POSITIONS = 5,
+    OFFSETS = 6,
+    TARGETS = 7,
+    WEIGHTS = 8,
+    CH_RANK = 16,
+    CH_OFFSETS = 17,
+    CH_TARGETS = 18,
+    CH_WEIGHTS = 19,
+    CH_MIDDLE = 20,
+    LANDMARKS = 24,
+    LANDMARK_DISTANCES = 25,
+};
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint32_t section_count;
+    std::uint32_t reserved;
+    std::uint64_t file_size;
+};
+static_assert(sizeof(Header) == 32, "unexpected padding in snapshot header");
+
+struct SectionEntry {
+    SectionKind kind;
+    std::uint32_t reserved;
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+static_assert(sizeof(SectionEntry) == 24, "unexpected padding in section");
+
+struct SectionData {
+    SectionKind kind;
+    const void *data;
+    std::size_t size;
+};
+
+template <typename T>
+static SectionData section(SectionKind kind, const Array<T> &a) {
+    return SectionData{kind, a.data(), a.size() * sizeof(T)};
+}
+
+static std::uint64_t align(std::uint64_t offset) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+void Snapshot::write(std::ostream &out, const Graph &g,
+                     const ContractionHierarchy *ch,
+                     const LandmarkHeuristic *landmarks) {
+    if (!g.is_frozen()) {
+        throw std::logic_error{"graph must be frozen before writing it"};
+    }
+
+    std::vector<SectionData> sections{
+        {SectionKind::GRAPH_NAME, g.graph_name.data(), g.graph_name.size()},
+        section(SectionKind::NAME_OFFSETS, g.name_offsets),
+        section(SectionKind::NAME_CHARS, g.name_chars),
+        section(SectionKind::SORTED_IDS, g.sorted_ids),
+        section(SectionKind::POSITIONS, g.positions),
+        section(SectionKind::OFFSETS, g.offsets),
+        section(SectionKind::TARGETS, g.targets),
+        section(SectionKind::WEIGHTS, g.weights),
+    };
+    if (ch != nullptr) {
+        if (&ch->graph() != &g) {
+            throw std::logic_error{"hierarchy belongs to a different graph"};
+        }
+        // Loaded along with the graph, it would pass for current.
+        ch->check_current();
+        sections.push_back(section(SectionKind::CH_RANK, ch->rank));
+        sections.push_back(section(SectionKind::CH_OFFSETS, ch->offsets));
+        sections.push_back(section(SectionKind::CH_TARGETS, ch->targets));
+        sections.push_back(section(SectionKind::CH_WEIGHTS, ch->weights));
+        sections.push_back(section(SectionKind::CH_MIDDLE, ch->middle));
+    }
+    if (landmarks != nullptr) {
+        if (&landmarks->graph() != &g) {
+            throw std::logic_error{"landmarks belong to a different graph"};
+        }
+        landmarks->check_current();
+        sections.push_back(section(SectionKind::LANDMARKS, landmarks->nodes));
+        sections.push_back(section(SectionKind::LANDMARK_DISTANCES,
+                                   landmarks->distances));
+    }
+
+    std::vector<SectionEntry> table;
+    std::uint64_t offset =
+        align(sizeof(Header) + sections.size() * sizeof(SectionEntry));
+    for (const SectionData &s : sections) {
+        table.push_back(SectionEntry{s.kind, 0, offset, s.size});
+        offset = align(offset + s.size);
+    }
+
+    Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.byte_order = byte_order_mark;
+    header.section_count = sections.size();
+    header.file_size = offset;
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(table.data()),
+              table.size() * sizeof(SectionEntry));
+    std::uint64_t written =
+        sizeof(Header) + table.size() * sizeof(SectionEntry);
+    static constexpr char padding[alignment] = {};
+    for (std::size_t i = 0; i < sections.size(); i++) {
+        out.write(padding, table[i].offset - written);
+        out.write(static_cast<const char *>(sections[i].data),
+                  sections[i].size);
+        written = table[i].offset + sections[i].size;
+    }
+    out.write(padding, offset - written);
+
+    if (!out) {
+        throw std::runtime_error{"failed to write snapshot"};
+    }
+}
+
+/**
+ * Typed access to the sections of a mapped snapshot.
+ */
+class SectionReader {
+  public:
+    SectionReader(const MappedFile &file, std::string path)
+        : file{file}, path{std::move(path)} {
+        Header header;
+        if (file.size() < sizeof(header)) {
+            throw invalid("file too short");
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, magic, sizeof(magic)) != 0) {
+            throw invalid("bad magic bytes");
+        }
+        if (header.byte_order != byte_order_mark) {
+            throw invalid("incompatible byte order");
+        }
+        if (header.version != version) {
+            throw invalid("unsupported version " +
+                          std::to_string(header.version));
+        }
+        if (header.file_size != file.size()) {
+            throw invalid("file size does not match header");
+        }
+        auto table_end =
+            sizeof(header) + std::uint64_t{header.section_count} *
+                                 sizeof(SectionEntry);
+        if (table_end > file.size()) {
+            throw invalid("section table exceeds file");
+        }
+
+        for (std::uint32_t i = 0; i < header.section_count; i++) {
+            SectionEntry entry;
+            std::memcpy(&entry,
+                        file.data() + sizeof(header) + i * sizeof(entry),
+                        sizeof(entry));
+            if (entry.offset % alignment != 0 || entry.offset > file.size() ||
+                entry.size > file.size() - entry.offset) {
+                throw invalid("section exceeds file");
+            }
+            sections[entry.kind] = entry;
+        }
+    }
+
+    bool has(SectionKind kind) const {
+        return sections.count(kind) > 0;
+    }
+
+    /**
+     * The given section as an array referring to the mapped file. Missing
+     * sections are empty.
+     */
+    template <typename T> Array<T> array(SectionKind kind) const {
+        auto it = sections.find(kind);
+        if (it == sections.end()) {
+            return {};
+        }
+        if (it->second.size % sizeof(T) != 0) {
+            throw invalid("truncated section");
+        }
+        return Array<T>{
+            reinterpret_cast<const T *>(file.data() + it->second.offset),
+            it->second.size / sizeof(T)};
+    }
+
+    std::runtime_error invalid(const std::string &reason) const {
+        return std::runtime_error{"invalid snapshot: " + path + ": " + reason};
+    }
+
+  private:
+    const MappedFile &file;
+    std::string path;
+    std::map<SectionKind, SectionEntry> sections;
+};
+
+Snapshot Snapshot::load(const std::string &path) {
+    auto file = std::make_shared<const MappedFile>(path);
+    SectionReader r{*file, path};
+
+    Snapshot s;
+    s.g = std::make_unique<Graph>();
+    Graph &g = *s.g;
+    Array<char> name = r.array<char>(SectionKind::GRAPH_NAME);
+    g.graph_name.assign(name.begin(), name.end());
+    g.name_offsets = r.array<std::uint64_t>(SectionKind::NAME_OFFSETS);
+    g.name_chars = r.array<char>(SectionKind::NAME_CHARS);
+    g.sorted_ids = r.array<NodeId>(SectionKind::SORTED_IDS);
+    g.positions = r.array<Position>(SectionKind::POSITIONS);
+    g.offsets = r.array<std::uint64_t>(SectionKind::OFFSETS);
+    g.targets = r.array<NodeId>(SectionKind::TARGETS);
+    g.weights = r.array<double>(SectionKind::WEIGHTS);
+    g.storage = file;
+    g.frozen = true;
+
+    if (g.offsets.empty() || g.offsets[0] != 0) {
+        throw r.invalid("missing adjacency");
+    }
+    std::size_t count = g.offsets.size() - 1;
+    if (g.name_offsets.size() != count + 1 || g.sorted_ids.size() != count ||
+        g.name_chars.size() != g.name_offsets.back()) {
+        throw r.invalid("inconsistent node names");
+    }
+    if (!g.positions.empty() && g.positions.size() != count) {
+        throw r.invalid("inconsistent node positions");
+    }
+    if (g.targets.size() != g.offsets.back() ||
+        g.weights.size() != g.offsets.back()) {
+        throw r.invalid("inconsistent adjacency");
+    }
+
+    if (r.has(SectionKind::CH_OFFSETS)) {
+        s.ch.reset(new ContractionHierarchy{g, file});
+        ContractionHierarchy &ch = *s.ch;
+        ch.rank = r.array<NodeId>(SectionKind::CH_RANK);
+        ch.offsets = r.array<std::uint64_t>(SectionKind::CH_OFFSETS);
+        ch.targets = r.array<NodeId>(SectionKind::CH_TARGETS);
+        ch.weights = r.array<double>(SectionKind::CH_WEIGHTS);
+        ch.middle = r.array<NodeId>(SectionKind::CH_MIDDLE);
+        if (ch.rank.size() != count || ch.offsets.size() != count + 1 ||
+            ch.targets.size() != ch.offsets.back() ||
+            ch.weights.size() != ch.offsets.back() ||
+            ch.middle.size() != ch.offsets.back()) {
+            throw r.invalid("inconsistent contraction hierarchy");
+        }
+    }
+
+    if (r.has(SectionKind::LANDMARKS)) {
+        s.alt.reset(new LandmarkHeuristic{g, file});
+        LandmarkHeuristic &alt = *s.alt;
+        alt.nodes = r.array<NodeId>(SectionKind::LANDMARKS);
+        alt.distances = r.array<double>(SectionKind::LANDMARK_DISTANCES);
+        if (alt.distances.size() != count * alt.nodes.size()) {
+            throw r.invalid("inconsistent landmarks");
+        }
+    }
+
+    return s;
+}
+
+bool Snapshot::is_snapshot(const std::string &path) {
+    std::ifstream in{path, std::ios::binary};
+    char buf[sizeof(magic)];
+    return in.read(buf, sizeof(buf)) &&
+           std::memcmp(buf, magic, sizeof(magic)) == 0;
+}
+
+const Graph &Snapshot::graph() const {
+    return *g;
+}
+
+const ContractionHierarchy *Snapshot::hierarchy() const {
+    return ch.get();
+}
+
+const LandmarkHeuristic *Snapshot::landmarks() const {
+    return alt.get();
+}
+
+} // namespace graphd
@@ -0,0 +1,44 @@
+#include <graphd/stats.hpp>
+
+namespace graphd {
+
+void RunStats::start_phase(std::string name) {
+    end_phase();
+    phase = std::move(name);
+    phase_start = Clock::now();
+}
+
+void RunStats::end_phase() {
+    if (phase.empty()) {
+        return;
+    }
+    std::chrono::duration<double, std::milli> elapsed =
+        Clock::now() - phase_start;
+    phases.emplace_back(std::move(phase), elapsed.count());
+    phase.clear();
+}
+
+void RunStats::write_json(std::ostream &out) const {
+    // Phase names are ours, none needs escaping.
+    out << "{\n  \"phases_ms\": {";
+    for (std::size_t i = 0; i < phases.size(); i++) {
+        out << (i == 0 ? "\n" : ",\n") << "    \"" << phases[i].first
+            << "\": " << phases[i].second;
+    }
+    out << (phases.empty() ? "},\n" : "\n  },\n");
+    out << "  \"graph\": {\"nodes\": " << nodes << ", \"edges\": " << edges
+        << "},\n";
+    out << "  \"counters\": " << (counters_enabled ? "true" : "false");
+    if (counters_enabled) {
+        out << ",\n  \"parse\": {\"tokens\": " << parse.tokens
+            << ", \"max_stack_depth\": " << parse.max_stack_depth
+            << ", \"statement_ms\": " << parse.statement_ms << "},\n";
+        out << "  \"search\": {\"settled\": " << search.settled
+            << ", \"relaxed\": " << search.relaxed
+            << ", \"heap_pushes\": " << search.pushes
+            << ", \"heap_pops\": " << search.pops << "}";
+    }
+    out << "\n}\n";
+}
+
+} // namespace graphd
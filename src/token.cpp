@@ -1,48 +1,50 @@
 #include <graphd/input/token.hpp>
 
-#include <cctype>
-#include <sstream>
 #include <stdexcept>
-#include <vector>
 
-static std::string downcase(std::string s) {
-    std::ostringstream buffer;
-    for (auto c : s) {
-        if (std::isupper(c)) {
-            buffer << (char)std::tolower(c);
-        } else {
-            buffer << c;
-        }
-    }
-    return buffer.str();
+// Character classes are spelled out rather than taken from <cctype>: they are
+// independent of the locale and cheap enough to matter on large inputs.
+static bool is_space(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f' ||
+           c == '\v';
 }
 
-static std::vector<std::string> supported_keywords{"graph", "strict"};
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
 
-static bool is_supported_keyword(std::string s) {
-    s = downcase(s);
-    for (auto kw : supported_keywords) {
-        if (s == kw) {
-            return true;
-        }
-    }
-    return false;
+static bool is_name_start(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static bool is_name_char(char c) {
+    return is_name_start(c) || is_digit(c);
 }
 
-static std::vector<std::string> unsupported_keywords{"node", "edge", "digraph",
-                                                     "subgraph"};
+static char downcase(char c) {
+    return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+}
 
-static bool is_unsupported_keyword(std::string s) {
-    s = downcase(s);
-    for (auto kw : unsupported_keywords) {
-        if (s == kw) {
-            throw std::runtime_error{"unsupported keyword: " + s};
+/**
+ * Whether s equals the given lower-case keyword, ignoring case.
+ */
+static bool is_keyword(std::string_view s, std::string_view keyword) {
+    if (s.size() != keyword.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < s.size(); i++) {
+        if (downcase(s[i]) != keyword[i]) {
+            return false;
         }
     }
-
-    return false;
+    return true;
 }
 
+static constexpr std::string_view supported_keywords[] = {"graph", "strict"};
+
+static constexpr std::string_view unsupported_keywords[] = {
+    "node", "edge", "digraph", "subgraph"};
+
 static const char fixed_tokens[] = ";,{}[]=";
 
 static bool is_fixed_token(int c) {
@@ -86,7 +88,7 @@ Token Token::from(char c) {
     }
 }
 
-Token Token::from(std::string s) {
+Token Token::from(std::string_view s) {
     if (s.size() == 1 && is_fixed_token(s.front())) {
         return Token::from(s.front());
     }
@@ -97,127 +99,146 @@ Token Token::from(std::string s) {
         throw std::runtime_error{
             "directed graphs not supported; illegal token: ->"};
 
-    if (is_supported_keyword(s)) {
-        return Token{TokenType::KEYWORD, downcase(s)};
-    } else if (is_unsupported_keyword(s)) {
-        throw std::runtime_error{"unsupported keyword: " + s};
-    } else {
-        return Token{TokenType::NAME, s};
+    for (auto kw : supported_keywords) {
+        if (is_keyword(s, kw)) {
+            return Token{TokenType::KEYWORD, kw};
+        }
+    }
+    for (auto kw : unsupported_keywords) {
+        if (is_keyword(s, kw)) {
+            throw std::runtime_error{"unsupported keyword: " +
+                                     std::string{kw}};
+        }
+    }
+    return Token{TokenType::NAME, s};
+}
+
+static std::string slurp(std::istream &in) {
+    std::string buffer;
+    char chunk[1 << 16];
+    while (in.read(chunk, sizeof(chunk)) || in.gcount() > 0) {
+        buffer.append(chunk, in.gcount());
     }
+    return buffer;
+}
+
+Tokenizer::Tokenizer(std::istream &in)
+    : buffer{std::make_unique<const std::string>(slurp(in))}, input{*buffer} {
 }
 
-Tokenizer::Tokenizer(std::istream &in) : in{in} {}
+Tokenizer::Tokenizer(std::string_view input) : input{input} {}
 
-std::string Tokenizer::read_string() {
-    std::ostringstream buffer;
-    std::string str{""};
+std::string_view Tokenizer::read_string() {
+    std::size_t start = pos;
+    bool escaped = false;
 
     while (true) {
-        int c = in.get();
-        switch (c) {
-        case EOF:
+        if (pos >= input.size()) {
             throw std::runtime_error{"encountered EOF while parsing string"};
-        case '\\':
-            buffer << (char)in.get();
-            continue;
-        case '"':
-            str = buffer.str();
-            if (str.empty()) {
-                throw std::runtime_error{"empty string"};
-            }
-            return str;
-        default:
-            buffer << (char)c;
         }
+        char c = input[pos];
+        if (c == '"') {
+            break;
+        }
+        if (c == '\\') {
+            escaped = true;
+            pos++;
+        }
+        pos++;
     }
-}
 
-std::string Tokenizer::read_name() {
-    std::ostringstream buffer;
+    std::string_view str = input.substr(start, pos - start);
+    pos++; // closing quote
+    if (str.empty()) {
+        throw std::runtime_error{"empty string"};
+    }
+    if (!escaped) {
+        return str;
+    }
 
-    while (true) {
-        int c = in.get();
-        if (std::isalnum(c)) {
-            buffer << (char)c;
-        } else if (c == EOF) {
-            return buffer.str();
-        } else {
-            // semicolon, comma, etc.
-            in.putback(c);
-            std::string name = buffer.str();
-            if (name.empty()) {
-                throw std::logic_error{"attempting to parse empty name"};
-            }
-            return name;
+    std::string &copy = unescaped.emplace_back();
+    copy.reserve(str.size());
+    for (std::size_t i = 0; i < str.size(); i++) {
+        if (str[i] == '\\') {
+            i++;
         }
+        copy.push_back(str[i]);
     }
+    return copy;
 }
 
-std::string Tokenizer::read_numeral() {
-    std::ostringstream buffer;
+std::string_view Tokenizer::read_name() {
+    std::size_t start = pos;
+    while (pos < input.size() && is_name_char(input[pos])) {
+        pos++;
+    }
+    return input.substr(start, pos - start);
+}
 
-    bool has_integer_part = false;
-    bool seen_decimal_point = false;
+std::string_view Tokenizer::read_numeral() {
+    std::size_t start = pos;
+    if (input[pos] == '-') {
+        pos++;
+    }
 
-    while (true) {
-        int c = in.get();
+    bool seen_digit = false;
+    bool seen_decimal_point = false;
+    for (; pos < input.size(); pos++) {
+        char c = input[pos];
         if (c == '.') {
             if (seen_decimal_point) {
-                throw std::runtime_error{"invalid numeral: " + buffer.str() +
-                                         "."};
+                throw std::runtime_error{
+                    "invalid numeral: " +
+                    std::string{input.substr(start, pos - start + 1)}};
             }
             seen_decimal_point = true;
-            buffer << '.';
-        } else if (std::isdigit(c)) {
-            if (!seen_decimal_point) {
-                has_integer_part = true;
-            }
-            buffer << (char)c;
+        } else if (is_digit(c)) {
+            seen_digit = true;
         } else {
-            if (!(seen_decimal_point || has_integer_part)) {
-                std::logic_error{"attempting to parse empty numeral"};
-            }
-            in.putback(c);
-            return buffer.str();
+            break;
         }
     }
+
+    std::string_view numeral = input.substr(start, pos - start);
+    if (!seen_digit) {
+        throw std::runtime_error{"invalid numeral: " + std::string{numeral}};
+    }
+    return numeral;
 }
 
 Token Tokenizer::next_token() {
-    // NOTE: Error handling not bulletproof. In particular, badbit needs to be
-    // checked after putback.
-    int c;
-    while ((c = in.get()) != EOF) {
-        if (std::isspace(c))
+    while (pos < input.size()) {
+        char c = input[pos];
+        if (is_space(c)) {
+            pos++;
             continue;
-        if (is_fixed_token(c))
-            return Token::from((char)c);
-        if (c == '"')
+        }
+        if (is_fixed_token(c)) {
+            pos++;
+            return Token::from(c);
+        }
+        if (c == '"') {
+            pos++;
             return Token{TokenType::NAME, read_string()};
+        }
         if (c == '-') {
-            c = in.get();
-            if (c == EOF) {
+            if (pos + 1 >= input.size()) {
                 throw std::runtime_error{"unexpected end of input"};
-            } else if (c == '-') {
-                return Token::from("--");
-            } else if (c == '>') {
-                return Token::from("->");
+            } else if (input[pos + 1] == '-' || input[pos + 1] == '>') {
+                pos += 2;
+                return Token::from(input.substr(pos - 2, 2));
             } else {
-                in.putback(c);
-                return Token{TokenType::NUMERAL, "-" + read_numeral()};
+                return Token{TokenType::NUMERAL, read_numeral()};
             }
         }
 
-        if (std::isalpha(c) || c == '_') {
-            in.putback(c);
-            std::string name = read_name();
-            return Token::from(name);
-        } else if (c == '.' || std::isdigit(c)) {
-            in.putback(c);
+        if (is_name_start(c)) {
+            return Token::from(read_name());
+        } else if (c == '.' || is_digit(c)) {
             return Token{TokenType::NUMERAL, read_numeral()};
         } else {
             throw std::runtime_error{"unexpected input byte: " +
-                                     std::to_string((char)c)};
+                                     std::to_string(c)};
         }
     }
 
@@ -0,0 +1,66 @@
+#include <graphd/workspace.hpp>
+
+#include <algorithm>
+#include <functional>
+
+namespace graphd {
+
+void SearchState::reset(std::size_t node_count) {
+    if (distances.size() != node_count) {
+        distances.assign(node_count, infinity);
+        parents.assign(node_count, no_node);
+        priorities.assign(node_count, infinity);
+    } else {
+        for (NodeId n : touched) {
+            distances[n] = infinity;
+            parents[n] = no_node;
+            priorities[n] = infinity;
+        }
+    }
+    touched.clear();
+    heap.clear();
+}
+
+bool SearchState::relax(NodeId n, double dist, NodeId parent,
+                        double priority) {
+    GRAPHD_COUNT(counters.relaxed++;)
+    if (!(dist < distances[n])) {
+        return false;
+    }
+    if (distances[n] == infinity) {
+        touched.push_back(n);
+    }
+    distances[n] = dist;
+    parents[n] = parent;
+    priorities[n] = priority;
+    heap.emplace_back(priority, n);
+    std::push_heap(heap.begin(), heap.end(), std::greater<Entry>{});
+    GRAPHD_COUNT(counters.pushes++;)
+    return true;
+}
+
+bool SearchState::has_next() {
+    while (!heap.empty()) {
+        auto [priority, n] = heap.front();
+        if (priority == priorities[n]) {
+            return true;
+        }
+        // Stale: n was queued again with a better priority, or settled.
+        std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>{});
+        heap.pop_back();
+        GRAPHD_COUNT(counters.pops++;)
+    }
+    return false;
+}
+
+NodeId SearchState::pop() {
+    NodeId n = heap.front().second;
+    std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>{});
+    heap.pop_back();
+    // Settled nodes can't be improved upon, any further entries are stale.
+    priorities[n] = -infinity;
+    GRAPHD_COUNT(counters.pops++; counters.settled++;)
+    return n;
+}
+
+} // namespace graphd
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <graphd/cache.hpp>
+#include <graphd/query.hpp>
+#include <graphd/workspace.hpp>
+
+using namespace graphd;
+
+/*
+ * a - b - c - d along the top, weight 1 each, and a - e - d below,
+ * weight 2 each.
+ */
+static Graph sample_graph() {
+    Graph g;
+    g.add_edge("a", "b", 1.0);
+    g.add_edge("b", "c", 1.0);
+    g.add_edge("c", "d", 1.0);
+    g.add_edge("a", "e", 2.0);
+    g.add_edge("e", "d", 2.0);
+    g.freeze();
+    return g;
+}
+
+static void update(Graph &g, QueryCache &cache, NodeName n1, NodeName n2,
+                   double weight) {
+    double old_weight = g.set_edge_weight(n1, n2, weight);
+    cache.edge_changed(n1, n2, old_weight, weight);
+}
+
+TEST(QueryCache, find) {
+    Graph g = sample_graph();
+    QueryCache cache{g, 4};
+    EXPECT_FALSE(cache.find("a", "d").has_value());
+
+    cache.insert("a", "d", g.shortest_path("a", "d"));
+    auto hit = cache.find("a", "d");
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_EQ(hit->total_distance, 3.0);
+    EXPECT_EQ(hit->nodes, (std::vector<NodeName>{"a", "b", "c", "d"}));
+    EXPECT_EQ(cache.size(), 1);
+
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_FALSE(cache.find("a", "d").has_value());
+}
+
+TEST(QueryCache, find_reversed) {
+    Graph g = sample_graph();
+    QueryCache cache{g, 4};
+    cache.insert("d", "a", g.shortest_path("d", "a"));
+
+    auto hit = cache.find("a", "d");
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_EQ(hit->total_distance, 3.0);
+    EXPECT_EQ(hit->nodes, (std::vector<NodeName>{"a", "b", "c", "d"}));
+    hit = cache.find("d", "a");
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_EQ(hit->nodes, (std::vector<NodeName>{"d", "c", "b", "a"}));
+
+    // Either direction replaces the other.
+    cache.insert("a", "d", g.shortest_path("a", "d"));
+    EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(QueryCache, evicts_least_recently_used) {
+    Graph g = sample_graph();
+    QueryCache cache{g, 2};
+    cache.insert("a", "b", g.shortest_path("a", "b"));
+    cache.insert("a", "c", g.shortest_path("a", "c"));
+    EXPECT_TRUE(cache.find("b", "a").has_value());
+    cache.insert("a", "d", g.shortest_path("a", "d"));
+
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_TRUE(cache.find("a", "b").has_value());
+    EXPECT_FALSE(cache.find("a", "c").has_value());
+    EXPECT_TRUE(cache.find("a", "d").has_value());
+}
+
+TEST(QueryCache, counters) {
+    Graph g = sample_graph();
+    QueryCache cache{g, 2};
+    cache.find("a", "d");
+    cache.insert("a", "d", g.shortest_path("a", "d"));
+    cache.find("a", "d");
+    cache.find("d", "a");
+    cache.clear();
+    cache.find("a", "d");
+
+    EXPECT_EQ(cache.counters().hits, 2);
+    EXPECT_EQ(cache.counters().misses, 2);
+}
+
+TEST(QueryCache, longer_edge_drops_paths_using_it) {
+    Graph g = sample_graph();
+    QueryCache cache{g, 8};
+    cache.insert("a", "b", g.shortest_path("a", "b"));
+    cache.insert("a", "d", g.shortest_path("a", "d"));
+    cache.insert("a", "e", g.shortest_path("a", "e"));
+
+    update(g, cache, "c", "b", 5.0);
+    EXPECT_TRUE(cache.find("a", "b").has_value());
+    EXPECT_FALSE(cache.find("a", "d").has_value());
+    EXPECT_TRUE(cache.find("a", "e").has_value());
+
+    update(g, cache, "a", "b", infinity);
+    EXPECT_FALSE(cache.find("a", "b").has_value());
+    EXPECT_TRUE(cache.find("a", "e").has_value());
+}
+
+TEST(QueryCache, shorter_edge_drops_longer_paths) {
+    Graph g = sample_graph();
+    QueryCache cache{g, 8};
+    cache.insert("a", "b", g.shortest_path("a", "b"));
+    cache.insert("a", "d", g.shortest_path("a", "d"));
+    cache.insert("b", "d", g.shortest_path("b", "d"));
+
+    // No path uses e - d, but any path longer than its new weight might
+    // now be shortened through it.
+    update(g, cache, "e", "d", 1.5);
+    EXPECT_TRUE(cache.find("a", "b").has_value());
+    EXPECT_FALSE(cache.find("a", "d").has_value());
+    EXPECT_FALSE(cache.find("b", "d").has_value());
+}
+
+TEST(QueryCache, answers_batch_queries) {
+    Graph g = sample_graph();
+    QueryCache cache{g, 8};
+    BatchOptions options;
+    options.cache = &cache;
+    SearchWorkspace ws;
+
+    EXPECT_EQ(answer_query(g, {"a", "d"}, ws, options).total_distance, 3.0);
+    EXPECT_EQ(cache.size(), 1);
+    EXPECT_ANY_THROW(answer_query(g, {"a", "x"}, ws, options));
+    EXPECT_EQ(cache.size(), 1);
+
+    update(g, cache, "e", "d", 0.5);
+    Path p = answer_query(g, {"a", "d"}, ws, options);
+    EXPECT_EQ(p.total_distance, 2.5);
+    EXPECT_EQ(p.nodes, (std::vector<NodeName>{"a", "e", "d"}));
+    EXPECT_EQ(answer_query(g, {"d", "a"}, ws, options).nodes,
+              (std::vector<NodeName>{"d", "e", "a"}));
+    EXPECT_EQ(cache.counters().hits, 1);
+}
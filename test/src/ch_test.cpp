@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+
+#include <graphd/ch.hpp>
+#include <graphd/matrix.hpp>
+#include <graphd/workspace.hpp>
+
+#include "random_graph.hpp"
+
+#include <string>
+
+using namespace graphd;
+using graphd::test::Random;
+using graphd::test::random_graph;
+
+static double edge_weight(const Graph &g, const NodeName &n1,
+                          const NodeName &n2) {
+    NodeId from = g.id_of(n1);
+    NodeId to = g.id_of(n2);
+    for (auto e = g.edges_begin(from); e < g.edges_end(from); e++) {
+        if (g.edge_target(e) == to) {
+            return g.edge_weight(e);
+        }
+    }
+    return -1.0;
+}
+
+TEST(ContractionHierarchy, same_node) {
+    Graph g;
+    g.add_edge("a", "b");
+    g.freeze();
+
+    ContractionHierarchy ch{g};
+    SearchWorkspace ws;
+    Path p = ch.shortest_path("a", "a", ws);
+
+    EXPECT_EQ(p.total_distance, 0.0);
+    EXPECT_EQ(p.nodes, std::vector<NodeName>{"a"});
+}
+
+TEST(ContractionHierarchy, fail_not_connected) {
+    Graph g;
+    g.add_edge("a", "b");
+    g.add_edge("c", "d");
+    g.freeze();
+
+    ContractionHierarchy ch{g};
+    SearchWorkspace ws;
+
+    EXPECT_ANY_THROW(ch.shortest_path("a", "d", ws));
+    EXPECT_ANY_THROW(ch.shortest_path("a", "x", ws));
+}
+
+TEST(ContractionHierarchy, fail_not_frozen) {
+    Graph g;
+    g.add_edge("a", "b");
+
+    EXPECT_ANY_THROW(ContractionHierarchy{g});
+}
+
+TEST(ContractionHierarchy, unpacks_shortcuts) {
+    Graph g;
+    // Contracting the inner nodes of the line requires shortcuts.
+    g.add_edge("a", "b", 1.0);
+    g.add_edge("b", "c", 1.0);
+    g.add_edge("c", "d", 1.0);
+    g.add_edge("d", "e", 1.0);
+    g.add_edge("a", "e", 10.0);
+    g.freeze();
+
+    ContractionHierarchy ch{g};
+    SearchWorkspace ws;
+    Path p = ch.shortest_path("a", "e", ws);
+
+    EXPECT_NEAR(p.total_distance, 4.0, 1E-8);
+    EXPECT_EQ(p.nodes, (std::vector<NodeName>{"a", "b", "c", "d", "e"}));
+}
+
+TEST(ContractionHierarchy, matches_dijkstra) {
+    Graph g = random_graph({500, 700, true}, 7);
+    ContractionHierarchy ch{g};
+    SearchWorkspace ws;
+    SearchWorkspace ws_ch;
+
+    Random rng{3};
+    for (int i = 0; i < 200; i++) {
+        NodeName from = rng.node(500);
+        NodeName to = rng.node(500);
+
+        Path expected = g.shortest_path(from, to, ws);
+        Path p = ch.shortest_path(from, to, ws_ch);
+
+        EXPECT_NEAR(p.total_distance, expected.total_distance, 1E-8);
+        ASSERT_EQ(p.nodes.front(), from);
+        ASSERT_EQ(p.nodes.back(), to);
+
+        // The unpacked path must consist of original edges.
+        double length = 0.0;
+        for (std::size_t h = 1; h < p.nodes.size(); h++) {
+            double w = edge_weight(g, p.nodes[h - 1], p.nodes[h]);
+            ASSERT_GE(w, 0.0);
+            length += w;
+        }
+        EXPECT_NEAR(length, p.total_distance, 1E-8);
+    }
+}
+
+TEST(ContractionHierarchy, matches_dijkstra_with_core) {
+    // Hubs with many neighbors stay uncontracted.
+    Graph g;
+    for (int i = 0; i < 300; i++) {
+        g.add_edge("hub" + std::to_string(i % 3), std::to_string(i),
+                   1.0 + i % 7);
+        g.add_edge(std::to_string(i), std::to_string((i + 1) % 300), 2.0);
+    }
+    g.freeze();
+
+    ContractionHierarchy ch{g};
+    SearchWorkspace ws;
+
+    for (int i = 0; i < 300; i += 7) {
+        NodeName from = std::to_string(i);
+        NodeName to = i % 2 ? "hub1" : std::to_string((i * 31) % 300);
+
+        Path expected = g.shortest_path(from, to, ws);
+        Path p = ch.shortest_path(from, to, ws);
+
+        EXPECT_NEAR(p.total_distance, expected.total_distance, 1E-8);
+        EXPECT_EQ(p.nodes.front(), from);
+        EXPECT_EQ(p.nodes.back(), to);
+    }
+}
+
+TEST(ContractionHierarchy, fail_out_of_date) {
+    Graph g;
+    g.add_edge("a", "b");
+    g.add_edge("b", "c");
+    g.freeze();
+
+    ContractionHierarchy ch{g};
+    SearchWorkspace ws;
+    EXPECT_EQ(ch.shortest_path("a", "c", ws).total_distance, 2.0);
+
+    g.set_edge_weight("a", "b", 3.0);
+    EXPECT_THROW(ch.shortest_path("a", "c", ws), std::logic_error);
+    EXPECT_THROW(ch.distance_matrix({"a"}, {"c"}), std::logic_error);
+}
@@ -0,0 +1,38 @@
+/*
+ * A DOT document for tests of parsing, with all the constructs that make
+ * splitting it up for parallel parsing tricky: semicolons, braces, brackets
+ * and escaped quotes inside quoted names and attribute values.
+ */
+#ifndef _GRAPHD_TEST_DOCUMENT_H_
+#define _GRAPHD_TEST_DOCUMENT_H_
+
+#include <sstream>
+#include <string>
+
+namespace graphd::test {
+
+/**
+ * A graph of up to 53 nodes and the given number of edge statements, some
+ * of them repeated, along with some node statements.
+ */
+inline std::string document(int edges) {
+    std::ostringstream out;
+    out << "strict graph \"par;allel\" {\n";
+    for (int i = 0; i < edges; i++) {
+        if (i % 7 == 0) {
+            out << "    n" << i % 50 << " [pos=\"" << i << "," << -i
+                << "\"];\n";
+        }
+        if (i % 11 == 0) {
+            out << "    \"q;}[\\\"" << i % 3 << "\" -- n" << i % 50 << ";\n";
+        }
+        out << "    n" << (i * 7) % 50 << " -- n" << (i * 13 + 1) % 50
+            << " [label=\"a;b\", weight=" << 1 + (i * 31) % 17 << "];\n";
+    }
+    out << "}\n";
+    return out.str();
+}
+
+} // namespace graphd::test
+
+#endif // _GRAPHD_TEST_DOCUMENT_H_
@@ -1,6 +1,16 @@
 #include <gtest/gtest.h>
 
 #include <graphd/graph.hpp>
+#include <graphd/heuristic.hpp>
+#include <graphd/landmarks.hpp>
+#include <graphd/pool.hpp>
+#include <graphd/workspace.hpp>
+
+#include "random_graph.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <set>
 
 using namespace graphd;
 
@@ -14,6 +24,7 @@ TEST(Graph, fail_no_such_node) {
     Graph g;
 
     g.add_edge("node_one", "node_two", 3.0);
+    g.freeze();
 
     EXPECT_ANY_THROW(g.shortest_path("node_one", "node_three"));
 }
@@ -23,6 +34,7 @@ TEST(Graph, shortest_same) {
 
     g.add_edge("a", "b");
 
+    g.freeze();
     Path p = g.shortest_path("a", "a");
 
     EXPECT_EQ(p.total_distance, 0.0);
@@ -38,8 +50,568 @@ TEST(Graph, shortest_1) {
     g.add_edge("c", "d", 0.5);
     g.add_edge("a", "d", 4.0);
 
+    g.freeze();
     Path p = g.shortest_path("a", "d");
 
     EXPECT_NEAR(p.total_distance, 3.5, 1E-8);
     EXPECT_EQ(p.nodes.size(), 4);
 }
+
+TEST(Graph, fail_not_connected) {
+    Graph g;
+
+    g.add_edge("a", "b");
+    g.add_edge("c", "d");
+    g.freeze();
+
+    EXPECT_ANY_THROW(g.shortest_path("a", "d"));
+}
+
+TEST(Graph, shortest_prefers_more_hops) {
+    Graph g;
+
+    // Long direct edges must not be settled before cheaper detours.
+    g.add_edge("s", "t", 10.0);
+    g.add_edge("s", "a", 1.0);
+    g.add_edge("a", "b", 1.0);
+    g.add_edge("b", "c", 1.0);
+    g.add_edge("c", "t", 1.0);
+    g.add_edge("a", "t", 5.0);
+
+    g.freeze();
+    Path p = g.shortest_path("s", "t");
+
+    EXPECT_NEAR(p.total_distance, 4.0, 1E-8);
+    EXPECT_EQ(p.nodes, (std::vector<NodeName>{"s", "a", "b", "c", "t"}));
+}
+
+TEST(Graph, node_ids) {
+    Graph g;
+
+    g.add_edge("x", "y");
+    g.add_edge("y", "z");
+    g.add_edge("z", "x");
+
+    EXPECT_EQ(g.node_count(), 3);
+    EXPECT_EQ(g.id_of("x"), 0);
+    EXPECT_EQ(g.id_of("z"), 2);
+    EXPECT_EQ(g.name_of(g.id_of("y")), "y");
+    EXPECT_ANY_THROW(g.id_of("w"));
+}
+
+TEST(Graph, freeze) {
+    Graph g;
+
+    g.add_edge("a", "b", 2.0);
+    g.add_edge("b", "a", 1.0);
+    g.add_edge("b", "c", 1.0);
+
+    EXPECT_FALSE(g.is_frozen());
+    EXPECT_ANY_THROW(g.shortest_path("a", "c"));
+
+    g.freeze();
+
+    EXPECT_TRUE(g.is_frozen());
+    EXPECT_EQ(g.edge_count(), 2);
+    EXPECT_ANY_THROW(g.add_edge("c", "d"));
+    EXPECT_NEAR(g.shortest_path("a", "c").total_distance, 2.0, 1E-8);
+}
+
+TEST(Graph, reuse_workspace) {
+    Graph g;
+
+    g.add_edge("a", "b", 1.0);
+    g.add_edge("b", "c", 1.0);
+    g.add_edge("c", "d", 1.0);
+    g.add_edge("x", "y", 1.0);
+    g.freeze();
+
+    SearchWorkspace ws;
+    EXPECT_NEAR(g.shortest_path("a", "d", ws).total_distance, 3.0, 1E-8);
+    EXPECT_ANY_THROW(g.shortest_path("a", "y", ws));
+    EXPECT_NEAR(g.shortest_path("d", "b", ws).total_distance, 2.0, 1E-8);
+    EXPECT_NEAR(g.shortest_path("y", "x", ws).total_distance, 1.0, 1E-8);
+}
+
+TEST(Graph, bidirectional_same) {
+    Graph g;
+
+    g.add_edge("a", "b");
+    g.freeze();
+
+    SearchWorkspace ws;
+    Path p = g.shortest_path("b", "b", ws, Algorithm::BIDIRECTIONAL);
+
+    EXPECT_EQ(p.total_distance, 0.0);
+    EXPECT_EQ(p.nodes, std::vector<NodeName>{"b"});
+}
+
+TEST(Graph, bidirectional_not_connected) {
+    Graph g;
+
+    g.add_edge("a", "b");
+    g.add_edge("c", "d");
+    g.freeze();
+
+    SearchWorkspace ws;
+    EXPECT_ANY_THROW(g.shortest_path("a", "d", ws, Algorithm::BIDIRECTIONAL));
+}
+
+TEST(Graph, bidirectional_matches_dijkstra) {
+    // A ring keeps the graph connected.
+    Graph g = test::random_graph({200, 200, false, 10.0}, 1);
+
+    SearchWorkspace ws;
+    test::Random rng{2};
+    for (int i = 0; i < 100; i++) {
+        NodeName from = rng.node(200);
+        NodeName to = rng.node(200);
+
+        Path uni = g.shortest_path(from, to, ws, Algorithm::DIJKSTRA);
+        Path bi = g.shortest_path(from, to, ws, Algorithm::BIDIRECTIONAL);
+
+        EXPECT_NEAR(uni.total_distance, bi.total_distance, 1E-8);
+        ASSERT_FALSE(bi.nodes.empty());
+        EXPECT_EQ(bi.nodes.front(), from);
+        EXPECT_EQ(bi.nodes.back(), to);
+
+        // The path must actually have the reported length.
+        SearchWorkspace check;
+        double length = 0.0;
+        for (std::size_t h = 1; h < bi.nodes.size(); h++) {
+            length += g.shortest_path(bi.nodes[h - 1], bi.nodes[h], check)
+                          .total_distance;
+        }
+        EXPECT_NEAR(length, bi.total_distance, 1E-8);
+    }
+}
+
+TEST(Graph, shortest_path_tree_matches_dijkstra) {
+    Graph g;
+    test::Random rng{7};
+    test::add_random_edges(g, {150, 300}, rng);
+    g.add_node("isolated");
+    g.freeze();
+
+    SearchWorkspace ws;
+    NodeId root = g.id_of("0");
+    ShortestPathTree tree = g.shortest_path_tree(root, ws);
+    ASSERT_EQ(tree.distance.size(), g.node_count());
+    EXPECT_EQ(tree.root, root);
+    EXPECT_EQ(tree.distance[root], 0.0);
+    EXPECT_EQ(tree.predecessor[root], no_node);
+
+    for (NodeId n = 0; n < g.node_count(); n++) {
+        NodeName name{g.name_of(n)};
+        if (tree.distance[n] == infinity) {
+            EXPECT_ANY_THROW(g.shortest_path("0", name, ws));
+            EXPECT_EQ(tree.predecessor[n], no_node);
+            continue;
+        }
+        EXPECT_NEAR(g.shortest_path("0", name, ws).total_distance,
+                    tree.distance[n], 1E-8);
+        if (n != root) {
+            // The predecessor must be a neighbor on a shortest path.
+            NodeId pred = tree.predecessor[n];
+            ASSERT_NE(pred, no_node);
+            double edge = g.shortest_path(NodeName{g.name_of(pred)}, name, ws)
+                              .total_distance;
+            EXPECT_NEAR(tree.distance[pred] + edge, tree.distance[n], 1E-8);
+        }
+    }
+    EXPECT_EQ(tree.distance[g.id_of("isolated")], infinity);
+}
+
+TEST(Graph, delta_stepping_matches_dijkstra) {
+    Graph g;
+    test::Random rng{11};
+    test::add_random_edges(g, {250, 600}, rng);
+    g.add_edge("0", "heavy", 1000.0);
+    g.add_node("isolated");
+    g.freeze();
+    g.remove_edge("0", "heavy");
+
+    SearchWorkspace ws;
+    NodeId root = g.id_of("0");
+    ShortestPathTree expected = g.shortest_path_tree(root, ws);
+
+    for (unsigned threads : {1, 3, 4}) {
+        ThreadPool pool{threads};
+        for (double delta : {0.0, 0.05, 1.0, 3.0, 100.0}) {
+            ShortestPathTree tree = g.shortest_path_tree(root, pool, delta);
+            EXPECT_EQ(tree.root, root);
+            ASSERT_EQ(tree.distance.size(), g.node_count());
+            EXPECT_EQ(tree.predecessor[root], no_node);
+            for (NodeId n = 0; n < g.node_count(); n++) {
+                if (expected.distance[n] == infinity) {
+                    EXPECT_EQ(tree.distance[n], infinity);
+                    EXPECT_EQ(tree.predecessor[n], no_node);
+                    continue;
+                }
+                EXPECT_NEAR(tree.distance[n], expected.distance[n], 1E-8);
+                if (n == root) {
+                    continue;
+                }
+                // The predecessor must be a neighbor on a shortest path.
+                NodeId pred = tree.predecessor[n];
+                ASSERT_NE(pred, no_node);
+                double edge = infinity;
+                for (auto e = g.edges_begin(pred); e < g.edges_end(pred);
+                     e++) {
+                    if (g.edge_target(e) == n) {
+                        edge = g.edge_weight(e);
+                    }
+                }
+                EXPECT_NEAR(tree.distance[pred] + edge, tree.distance[n],
+                            1E-8);
+            }
+            EXPECT_EQ(tree.distance[g.id_of("heavy")], infinity);
+        }
+    }
+}
+
+TEST(Graph, fail_delta_stepping) {
+    ThreadPool pool{2};
+    Graph g;
+    g.add_edge("a", "b", 2.0);
+    EXPECT_THROW(g.shortest_path_tree(0, pool), std::logic_error);
+    g.freeze();
+    EXPECT_THROW(g.shortest_path_tree(2, pool), std::out_of_range);
+    EXPECT_THROW(g.shortest_path_tree(0, pool, -1.0), std::runtime_error);
+    EXPECT_THROW(g.shortest_path_tree(0, pool, infinity),
+                 std::runtime_error);
+    EXPECT_EQ(g.shortest_path_tree(1, pool).distance[0], 2.0);
+}
+
+TEST(Graph, shortest_path_tree_by_name) {
+    Graph g;
+    g.add_edge("a", "b", 2.0);
+    g.add_edge("b", "c", 1.0);
+    g.freeze();
+
+    ShortestPathTree tree = g.shortest_path_tree("c");
+    EXPECT_EQ(tree.distance[g.id_of("a")], 3.0);
+    EXPECT_EQ(tree.predecessor[g.id_of("a")], g.id_of("b"));
+    EXPECT_ANY_THROW(g.shortest_path_tree("x"));
+}
+
+TEST(Graph, positions) {
+    Graph g;
+
+    g.add_node("lonely");
+    g.set_position("a", Position{1.0, 2.0});
+    g.add_edge("a", "b");
+    g.freeze();
+
+    EXPECT_EQ(g.node_count(), 3);
+    ASSERT_TRUE(g.position(g.id_of("a")).has_value());
+    EXPECT_EQ(g.position(g.id_of("a"))->y, 2.0);
+    EXPECT_FALSE(g.position(g.id_of("b")).has_value());
+    EXPECT_ANY_THROW(g.set_position("a", Position{0.0, 0.0}));
+}
+
+TEST(Graph, astar_matches_dijkstra) {
+    Graph g;
+
+    // Grid with unit spacing and edges at least as long as their endpoints'
+    // distance, so both heuristics are admissible.
+    const int side = 15;
+    auto name = [](int r, int c) {
+        return std::to_string(r) + "_" + std::to_string(c);
+    };
+    for (int r = 0; r < side; r++) {
+        for (int c = 0; c < side; c++) {
+            g.set_position(name(r, c), Position{double(c), double(r)});
+            if (r + 1 < side) {
+                g.add_edge(name(r, c), name(r + 1, c), 1.0 + (r * c) % 3);
+            }
+            if (c + 1 < side) {
+                g.add_edge(name(r, c), name(r, c + 1), 1.0 + (r + c) % 2);
+            }
+        }
+    }
+    g.freeze();
+
+    SearchWorkspace ws;
+    ManhattanHeuristic manhattan{g};
+    for (int i = 0; i < side; i++) {
+        NodeName from = name(i, (i * 7) % side);
+        NodeName to = name((i * 11) % side, side - 1 - i);
+
+        Path d = g.shortest_path(from, to, ws, Algorithm::DIJKSTRA);
+        Path a = g.shortest_path(from, to, ws, Algorithm::ASTAR);
+        Path m = g.shortest_path(from, to, ws, manhattan);
+
+        EXPECT_NEAR(d.total_distance, a.total_distance, 1E-8);
+        EXPECT_NEAR(d.total_distance, m.total_distance, 1E-8);
+        EXPECT_EQ(a.nodes.front(), from);
+        EXPECT_EQ(m.nodes.back(), to);
+    }
+}
+
+TEST(Graph, fail_landmarks_out_of_date) {
+    Graph g;
+    g.add_edge("a", "b", 4.0);
+    g.add_edge("b", "c", 1.0);
+    g.freeze();
+
+    LandmarkHeuristic alt{g, 2};
+    SearchWorkspace ws;
+    EXPECT_EQ(g.shortest_path("a", "c", ws, alt).total_distance, 5.0);
+
+    g.set_edge_weight("a", "b", 1.0);
+    EXPECT_THROW(alt.check_current(), std::logic_error);
+    EXPECT_THROW(g.shortest_path("a", "c", ws, alt), std::logic_error);
+}
+
+TEST(Graph, landmarks_admissible) {
+    Graph g;
+    test::Random rng{11};
+    test::add_random_edges(g, {100, 200}, rng);
+    // A second component needs landmarks of its own.
+    g.add_edge("x", "y", 2.0);
+    g.add_edge("y", "z", 3.0);
+    g.freeze();
+
+    LandmarkHeuristic alt{g, 4};
+    ASSERT_EQ(alt.landmarks().size(), 4);
+    bool in_xyz = false;
+    for (NodeId l : alt.landmarks()) {
+        NodeName name{g.name_of(l)};
+        in_xyz = in_xyz || name == "x" || name == "y" || name == "z";
+    }
+    EXPECT_TRUE(in_xyz);
+    EXPECT_EQ(alt.estimate(g.id_of("x"), g.id_of("z")), 5.0);
+
+    SearchWorkspace ws;
+    for (NodeId from = 0; from < g.node_count(); from += 5) {
+        ShortestPathTree tree = g.shortest_path_tree(from, ws);
+        for (NodeId to = 0; to < g.node_count(); to++) {
+            EXPECT_LE(alt.estimate(from, to), tree.distance[to] + 1E-8);
+        }
+    }
+}
+
+TEST(Graph, landmarks_match_dijkstra) {
+    Graph g = test::random_graph({300, 300, false, 5.0}, 5);
+
+    // More landmarks than nodes are not an error.
+    EXPECT_EQ(LandmarkHeuristic(g, 1000).landmarks().size(), g.node_count());
+
+    LandmarkHeuristic alt{g};
+    SearchWorkspace ws;
+    test::Random rng{6};
+    for (int i = 0; i < 100; i++) {
+        NodeName from = rng.node(300);
+        NodeName to = rng.node(300);
+
+        Path d = g.shortest_path(from, to, ws, Algorithm::DIJKSTRA);
+        Path a = g.shortest_path(from, to, ws, alt);
+
+        EXPECT_NEAR(d.total_distance, a.total_distance, 1E-8);
+        EXPECT_EQ(a.nodes.front(), from);
+        EXPECT_EQ(a.nodes.back(), to);
+    }
+}
+
+TEST(Graph, merge) {
+    std::vector<Graph> parts(3);
+    parts[0].add_edge("a", "b", 5.0);
+    parts[0].add_edge("b", "c", 1.0);
+    parts[1].add_node("d");
+    parts[1].add_edge("c", "a", 2.0);
+    parts[1].add_edge("b", "a", 3.0);
+    parts[2].set_position("e", Position{1.0, 2.0});
+    parts[2].add_edge("a", "b", 4.0);
+
+    Graph g;
+    g.add_node("z");
+    ThreadPool pool{2};
+    g.merge(std::move(parts), pool);
+    g.freeze();
+
+    ASSERT_EQ(g.node_count(), 6);
+    const char *names[] = {"z", "a", "b", "c", "d", "e"};
+    for (NodeId n = 0; n < 6; n++) {
+        EXPECT_EQ(g.name_of(n), names[n]);
+    }
+    EXPECT_EQ(g.edge_count(), 3);
+    EXPECT_EQ(g.shortest_path("a", "b").total_distance, 3.0);
+    EXPECT_TRUE(g.position(g.id_of("e")).has_value());
+}
+
+TEST(Graph, k_shortest_paths) {
+    Graph g;
+    // Yen's original example
+    g.add_edge("c", "d", 3.0);
+    g.add_edge("c", "e", 2.0);
+    g.add_edge("d", "f", 4.0);
+    g.add_edge("e", "d", 1.0);
+    g.add_edge("e", "f", 2.0);
+    g.add_edge("e", "g", 3.0);
+    g.add_edge("f", "g", 2.0);
+    g.add_edge("f", "h", 1.0);
+    g.add_edge("g", "h", 2.0);
+    g.freeze();
+
+    std::vector<Path> paths = g.k_shortest_paths("c", "h", 3);
+    ASSERT_EQ(paths.size(), 3);
+    EXPECT_EQ(paths[0].total_distance, 5.0);
+    EXPECT_EQ(paths[0].nodes, (std::vector<NodeName>{"c", "e", "f", "h"}));
+    EXPECT_EQ(paths[1].total_distance, 7.0);
+    EXPECT_EQ(paths[2].total_distance, 7.0);
+    EXPECT_NE(paths[1].nodes, paths[2].nodes);
+
+    // There are only so many loopless paths.
+    std::vector<Path> all = g.k_shortest_paths("c", "h", 1000);
+    EXPECT_LT(all.size(), 1000);
+    for (std::size_t i = 1; i < all.size(); i++) {
+        EXPECT_LE(all[i - 1].total_distance, all[i].total_distance);
+        EXPECT_NE(all[i - 1].nodes, all[i].nodes);
+    }
+
+    EXPECT_TRUE(g.k_shortest_paths("c", "h", 0).empty());
+    EXPECT_EQ(g.k_shortest_paths("c", "c", 5).size(), 1);
+}
+
+TEST(Graph, k_shortest_paths_loopless_and_complete) {
+    Graph g;
+    const int side = 4;
+    auto name = [](int r, int c) {
+        return std::to_string(r) + "_" + std::to_string(c);
+    };
+    for (int r = 0; r < side; r++) {
+        for (int c = 0; c < side; c++) {
+            if (r + 1 < side) {
+                g.add_edge(name(r, c), name(r + 1, c), 1.0 + (r + c) % 3);
+            }
+            if (c + 1 < side) {
+                g.add_edge(name(r, c), name(r, c + 1), 1.0 + (r * c) % 2);
+            }
+        }
+    }
+    g.add_edge("x", "y");
+    g.freeze();
+
+    SearchWorkspace ws;
+    std::vector<Path> paths =
+        g.k_shortest_paths(name(0, 0), name(side - 1, side - 1), 40, ws);
+    ASSERT_EQ(paths.size(), 40);
+    EXPECT_EQ(paths[0].total_distance,
+              g.shortest_path(name(0, 0), name(side - 1, side - 1))
+                  .total_distance);
+
+    std::set<std::vector<NodeName>> distinct;
+    for (std::size_t i = 0; i < paths.size(); i++) {
+        const Path &p = paths[i];
+        distinct.insert(p.nodes);
+        if (i > 0) {
+            EXPECT_LE(paths[i - 1].total_distance, p.total_distance);
+        }
+        // No node twice, and the length adds up.
+        EXPECT_EQ(std::set<NodeName>(p.nodes.begin(), p.nodes.end()).size(),
+                  p.nodes.size());
+        double length = 0.0;
+        for (std::size_t h = 1; h < p.nodes.size(); h++) {
+            length += g.shortest_path(p.nodes[h - 1], p.nodes[h], ws)
+                          .total_distance;
+        }
+        EXPECT_LE(length, p.total_distance + 1E-8);
+    }
+    EXPECT_EQ(distinct.size(), paths.size());
+
+    // Compare with the lengths of all loopless paths, found by brute force.
+    std::vector<double> lengths;
+    std::vector<bool> visited(g.node_count());
+    NodeId target = g.id_of(name(side - 1, side - 1));
+    std::function<void(NodeId, double)> visit = [&](NodeId n, double length) {
+        if (n == target) {
+            lengths.push_back(length);
+            return;
+        }
+        visited[n] = true;
+        for (auto e = g.edges_begin(n); e < g.edges_end(n); e++) {
+            if (!visited[g.edge_target(e)]) {
+                visit(g.edge_target(e), length + g.edge_weight(e));
+            }
+        }
+        visited[n] = false;
+    };
+    visit(g.id_of(name(0, 0)), 0.0);
+    std::sort(lengths.begin(), lengths.end());
+    for (std::size_t i = 0; i < paths.size(); i++) {
+        EXPECT_NEAR(paths[i].total_distance, lengths[i], 1E-8);
+    }
+
+    EXPECT_ANY_THROW(g.k_shortest_paths("x", name(0, 0), 3, ws));
+}
+
+TEST(Graph, set_edge_weight) {
+    Graph g;
+    g.add_edge("a", "b", 1.0);
+    g.add_edge("b", "c", 1.0);
+    g.add_edge("a", "c", 3.0);
+    g.freeze();
+    EXPECT_EQ(g.revision(), 0);
+
+    EXPECT_EQ(g.set_edge_weight("b", "c", 5.0), 1.0);
+    EXPECT_EQ(g.revision(), 1);
+    Path p = g.shortest_path("a", "c");
+    EXPECT_EQ(p.total_distance, 3.0);
+    EXPECT_EQ(p.nodes, (std::vector<NodeName>{"a", "c"}));
+    // Both directions change.
+    EXPECT_EQ(g.shortest_path("c", "b").total_distance, 4.0);
+
+    EXPECT_EQ(g.set_edge_weight("c", "b", 0.5), 5.0);
+    EXPECT_EQ(g.shortest_path("a", "c").total_distance, 1.5);
+    SearchWorkspace ws;
+    Path bi = g.shortest_path("a", "c", ws, Algorithm::BIDIRECTIONAL);
+    EXPECT_EQ(bi.total_distance, 1.5);
+}
+
+TEST(Graph, set_edge_weight_before_freeze) {
+    Graph g;
+    g.add_edge("a", "b", 1.0);
+    g.add_edge("a", "c", 3.0);
+    g.add_edge("b", "c", 1.0);
+
+    // Unlike add_edge, the weight may go up.
+    EXPECT_EQ(g.set_edge_weight("a", "b", 4.0), 1.0);
+    g.freeze();
+    EXPECT_EQ(g.shortest_path("a", "b").total_distance, 4.0);
+}
+
+TEST(Graph, remove_edge) {
+    Graph g;
+    g.add_edge("a", "b", 1.0);
+    g.add_edge("b", "c", 1.0);
+    g.add_edge("c", "d", 1.0);
+    g.add_edge("a", "d", 10.0);
+    g.freeze();
+
+    EXPECT_EQ(g.remove_edge("b", "c"), 1.0);
+    EXPECT_EQ(g.edge_count(), 4);
+    EXPECT_EQ(g.shortest_path("a", "c").total_distance, 11.0);
+    EXPECT_EQ(g.shortest_path_tree("b").distance[g.id_of("c")], 12.0);
+
+    g.remove_edge("a", "d");
+    SearchWorkspace ws;
+    EXPECT_ANY_THROW(g.shortest_path("a", "d"));
+    EXPECT_ANY_THROW(g.shortest_path("a", "d", ws, Algorithm::BIDIRECTIONAL));
+
+    g.set_edge_weight("b", "c", 2.0);
+    EXPECT_EQ(g.shortest_path("a", "d").total_distance, 4.0);
+}
+
+TEST(Graph, fail_set_edge_weight) {
+    Graph g;
+    g.add_edge("a", "b", 1.0);
+    g.add_node("c");
+    g.freeze();
+
+    EXPECT_THROW(g.set_edge_weight("a", "c", 1.0), std::runtime_error);
+    EXPECT_THROW(g.set_edge_weight("a", "x", 1.0), std::runtime_error);
+    EXPECT_THROW(g.set_edge_weight("a", "b", -1.0), std::runtime_error);
+    EXPECT_EQ(g.revision(), 0);
+    EXPECT_EQ(g.shortest_path("a", "b").total_distance, 1.0);
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <graphd/ch.hpp>
+#include <graphd/matrix.hpp>
+#include <graphd/workspace.hpp>
+
+#include "random_graph.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace graphd;
+
+/**
+ * A connected random graph, along with x -- y connected to nothing else.
+ */
+static Graph random_graph(int nodes, int extra_edges, unsigned seed) {
+    return test::random_graph({nodes, extra_edges, true, 0, true}, seed);
+}
+
+static std::vector<NodeName> some_nodes(int count, int nodes, unsigned seed) {
+    std::vector<NodeName> picked;
+    test::Random rng{seed};
+    for (int i = 0; i < count; i++) {
+        picked.push_back(rng.node(nodes));
+    }
+    picked.push_back("x");
+    return picked;
+}
+
+static void expect_pairwise(const Graph &g, const DistanceMatrix &m,
+                            const std::vector<NodeName> &sources,
+                            const std::vector<NodeName> &targets) {
+    ASSERT_EQ(m.rows(), sources.size());
+    ASSERT_EQ(m.columns(), targets.size());
+    SearchWorkspace ws;
+    for (std::size_t i = 0; i < sources.size(); i++) {
+        for (std::size_t j = 0; j < targets.size(); j++) {
+            double expected = infinity;
+            try {
+                expected = g.shortest_path(sources[i], targets[j], ws)
+                               .total_distance;
+            } catch (const std::runtime_error &) {
+                // not connected
+            }
+            if (expected == infinity) {
+                EXPECT_EQ(m.at(i, j), infinity);
+            } else {
+                EXPECT_NEAR(m.at(i, j), expected, 1E-8);
+            }
+        }
+    }
+}
+
+TEST(DistanceMatrix, graph_matches_pairwise) {
+    Graph g = random_graph(300, 300, 3);
+    auto sources = some_nodes(20, 300, 1);
+    auto targets = some_nodes(30, 300, 2);
+    // Duplicates are allowed.
+    targets.push_back(targets.front());
+
+    for (unsigned threads : {1, 3}) {
+        expect_pairwise(g, g.distance_matrix(sources, targets, threads),
+                        sources, targets);
+    }
+}
+
+TEST(DistanceMatrix, hierarchy_matches_pairwise) {
+    Graph g = random_graph(300, 300, 5);
+    ContractionHierarchy ch{g};
+    auto sources = some_nodes(20, 300, 3);
+    auto targets = some_nodes(30, 300, 4);
+    targets.push_back(targets.front());
+
+    for (unsigned threads : {1, 3}) {
+        expect_pairwise(g, ch.distance_matrix(sources, targets, threads),
+                        sources, targets);
+    }
+}
+
+TEST(DistanceMatrix, unknown_node) {
+    Graph g = random_graph(10, 0, 1);
+    ContractionHierarchy ch{g};
+
+    EXPECT_ANY_THROW(g.distance_matrix({"1"}, {"nope"}));
+    EXPECT_ANY_THROW(ch.distance_matrix({"nope"}, {"1"}));
+}
+
+TEST(DistanceMatrix, empty) {
+    Graph g = random_graph(10, 0, 1);
+    DistanceMatrix m = g.distance_matrix({}, {"1", "2"});
+
+    EXPECT_EQ(m.rows(), 0);
+    EXPECT_EQ(m.columns(), 2);
+}
+
+TEST(DistanceMatrix, write_binary) {
+    DistanceMatrix m{2, 3};
+    for (std::size_t i = 0; i < 2; i++) {
+        for (std::size_t j = 0; j < 3; j++) {
+            m.at(i, j) = 10.0 * i + j;
+        }
+    }
+
+    std::ostringstream out;
+    m.write_binary(out);
+    std::string bytes = out.str();
+    ASSERT_EQ(bytes.size(), 2 * sizeof(std::uint64_t) + 6 * sizeof(double));
+
+    std::uint64_t shape[2];
+    std::memcpy(shape, bytes.data(), sizeof(shape));
+    EXPECT_EQ(shape[0], 2);
+    EXPECT_EQ(shape[1], 3);
+    double distances[6];
+    std::memcpy(distances, bytes.data() + sizeof(shape), sizeof(distances));
+    EXPECT_EQ(distances[4], 11.0);
+    EXPECT_EQ(distances[5], 12.0);
+}
+
+TEST(DistanceMatrix, write_text) {
+    DistanceMatrix m{2, 2};
+    m.at(0, 0) = 0.0;
+    m.at(0, 1) = 2.5;
+    m.at(1, 0) = 2.5;
+
+    std::ostringstream out;
+    m.write_text(out);
+    EXPECT_EQ(out.str(), "0\t2.5\n2.5\tinf\n");
+}
@@ -1,274 +1,95 @@
 #include <gtest/gtest.h>
 
-#include <graphd/input/parser/reduce.hpp>
+#include <graphd/input/load.hpp>
+#include <graphd/input/parser/expr.hpp>
+
+#include "document.hpp"
 
 #include <sstream>
 #include <string>
+#include <string_view>
 
 using namespace graphd::input;
+using graphd::test::document;
 
-Token t(char c) {
-    switch (c) {
-    case '\0':
-        return Token{TokenType::EOI, ""};
-    case '}':
-        return Token{TokenType::CLOSING_BRACE, ""};
-    case ']':
-        return Token{TokenType::CLOSING_SQUARE_BRACKET, ""};
-    case ';':
-        return Token{TokenType::SEMICOLON, ""};
-    case ',':
-        return Token{TokenType::COMMA, ""};
-    default:
-        throw std::logic_error{"no token shorthand for " + std::to_string(c)};
-    }
+static void parse(std::string_view code) {
+    Parser::of(code).parse();
 }
 
-void add_tokens(ParseStack &s, std::string code) {
-    std::istringstream in{code};
-    Tokenizer tok{in};
-
-    ParseStack tokens;
-
-    for (Token t = tok.next_token(); t.type != TokenType::EOI;
-         t = tok.next_token()) {
-        s.push_back(new expr::TokenExpr{t});
-    }
+static graphd::Graph load(std::string_view code) {
+    graphd::Graph g;
+    Parser::of(code).parse_into(g);
+    g.freeze();
+    return g;
 }
 
-void cleanup(ParseStack &s) {
-    for (auto e : s) {
-        delete e;
-    }
+static double weight(const graphd::Graph &g, const graphd::NodeName &n1,
+                     const graphd::NodeName &n2) {
+    return g.shortest_path(n1, n2).total_distance;
 }
 
-TEST(ReductionSuccess, attribute) {
-    reduce::ToAttribute to_attr;
-    ParseStack stack;
-    add_tokens(stack, "key=value");
-
-    EXPECT_TRUE(to_attr.perform(t('\0'), stack));
-    EXPECT_EQ(stack.size(), 1);
-    EXPECT_TRUE(expr::Attribute::is_instance(stack.back()));
-
-    add_tokens(stack, ",weight=2.0");
-
-    EXPECT_TRUE(to_attr.perform(t('\0'), stack));
-    EXPECT_EQ(stack.size(), 2);
-    EXPECT_TRUE(expr::Attribute::is_instance(stack.back()));
-
-    cleanup(stack);
+TEST(ParseSuccess, attributes) {
+    auto g = load("graph { a -- b [key=value, weight=2.0]; }");
+    EXPECT_EQ(weight(g, "a", "b"), 2.0);
 }
 
-TEST(ReductionFail, attributeNoValue) {
-    reduce::ToAttribute to_attr;
-    ParseStack stack;
-    add_tokens(stack, "weight=,");
-
-    auto pre_size = stack.size();
-    EXPECT_FALSE(to_attr.perform(t('\0'), stack));
-    EXPECT_EQ(stack.size(), pre_size);
-
-    cleanup(stack);
+TEST(ParseSuccess, attributesNoComma) {
+    auto g = load("graph { a -- b [color=red weight=3]; }");
+    EXPECT_EQ(weight(g, "a", "b"), 3.0);
 }
 
-TEST(ReductionSuccess, attributeNoComma) {
-    reduce::ToAttribute to_attr;
-    ParseStack stack;
-    add_tokens(stack, "[weight=1.0");
-
-    EXPECT_TRUE(to_attr.perform(t('\0'), stack));
-    EXPECT_EQ(stack.size(), 2);
-    EXPECT_TRUE(expr::Attribute::is_instance(stack.back()));
-
-    cleanup(stack);
+TEST(ParseSuccess, attributesLeadingComma) {
+    auto g = load("graph { a -- b [, weight=4]; }");
+    EXPECT_EQ(weight(g, "a", "b"), 4.0);
 }
 
-TEST(ReductionSuccess, alist) {
-    reduce::ToAList to_alist;
-    ParseStack stack;
-    add_tokens(stack, "[");
-    stack.push_back(new expr::Attribute("key", "value"));
-
-    EXPECT_TRUE(to_alist.perform(t(','), stack));
-    EXPECT_EQ(stack.size(), 2);
-    EXPECT_TRUE(expr::AList::is_instance(stack.back()));
-
-    cleanup(stack);
+TEST(ParseFail, attributeNoValue) {
+    ASSERT_ANY_THROW(parse("graph { a -- b [weight=,]; }"));
 }
 
-TEST(ReductionFail, alist) {
-    reduce::ToAList to_alist;
-    ParseStack stack;
-    add_tokens(stack, ",zero=0");
-
-    auto pre_size = stack.size();
-    EXPECT_FALSE(to_alist.perform(t(','), stack));
-    EXPECT_EQ(stack.size(), pre_size);
-
-    cleanup(stack);
+TEST(ParseFail, emptyAttributeList) {
+    ASSERT_ANY_THROW(parse("graph { a -- b []; }"));
 }
 
-TEST(ReductionSuccess, attr_list) {
-    reduce::ToAttrList to_attr_list;
-    ParseStack stack;
-    stack.push_back(new expr::TokenExpr{Token::from('[')});
-    expr::AList *alist = new expr::AList;
-    alist->add_attribute(new expr::Attribute("name", "value"));
-    stack.push_back(alist);
-    stack.push_back(new expr::TokenExpr{Token::from(']')});
-
-    EXPECT_TRUE(to_attr_list.perform(Token::from(';'), stack));
-    EXPECT_EQ(stack.size(), 1);
-    ASSERT_TRUE(expr::AttributeList::is_instance(stack.back()));
-
-    expr::AttributeList *attrs =
-        static_cast<expr::AttributeList *>(stack.back());
-    auto att = attrs->get_attr("name");
-    ASSERT_TRUE(att.has_value());
-    ASSERT_EQ(att.value(), "value");
-
-    cleanup(stack);
+TEST(ParseFail, attributesNoBrackets) {
+    ASSERT_ANY_THROW(parse("graph { a -- b weight=2; }"));
 }
 
-TEST(ReductionFail, attr_list_no_alist) {
-    reduce::ToAttrList to_attr_list;
-    ParseStack stack;
-    stack.push_back(new expr::TokenExpr{Token::from('[')});
-    stack.push_back(new expr::Attribute("attr", "value"));
-    stack.push_back(new expr::TokenExpr{Token::from(']')});
-
-    auto pre_size = stack.size();
-    EXPECT_FALSE(to_attr_list.perform(Token::from(';'), stack));
-    EXPECT_EQ(stack.size(), pre_size);
-
-    cleanup(stack);
+TEST(ParseSuccess, statements) {
+    auto g = load("strict graph {\n\ta -- b;\n\tb -- c;\n}");
+    EXPECT_EQ(g.node_count(), 3);
+    EXPECT_EQ(g.edge_count(), 2);
 }
 
-TEST(ReductionSuccess, statement) {
-    reduce::ToStatement to_stmt;
-    ParseStack stack;
-    add_tokens(stack, "strict graph {\n\ta -- b;");
-
-    EXPECT_TRUE(to_stmt.perform(t('}'), stack));
-    EXPECT_EQ(stack.size(), 4);
-    EXPECT_TRUE(expr::Statement::is_instance(stack.back()));
-
-    add_tokens(stack, "b -- c;");
-
-    EXPECT_TRUE(to_stmt.perform(t('}'), stack));
-    EXPECT_EQ(stack.size(), 5);
-    EXPECT_TRUE(expr::Statement::is_instance(stack.back()));
-
-    cleanup(stack);
-}
-
-TEST(ReductionFail, statement) {
-    reduce::ToStatement to_stmt;
-    ParseStack stack;
-    add_tokens(stack, "{ a -- b }");
-
-    auto pre_size = stack.size();
-    EXPECT_FALSE(to_stmt.perform(t('\0'), stack));
-    EXPECT_EQ(stack.size(), pre_size);
-
-    cleanup(stack);
+TEST(ParseFail, statementNoSemicolon) {
+    ASSERT_ANY_THROW(parse("graph { a -- b }"));
 }
 
-TEST(ReductionSuccess, stmtListNew) {
-    reduce::ToStmtList to_list;
-    ParseStack stack;
-    add_tokens(stack, "graph foo {");
-    stack.push_back(new expr::EdgeStmt{"a", "b"});
-    stack.push_back(new expr::EdgeStmt{"c", "d"});
-
-    EXPECT_TRUE(to_list.perform(t('}'), stack));
-    EXPECT_EQ(stack.size(), 4);
-    EXPECT_TRUE(expr::StmtList::is_instance(stack.back()));
-
-    cleanup(stack);
-}
-
-TEST(ReductionSuccess, stmtListExists) {
-    reduce::ToStmtList to_list;
-    ParseStack stack;
-    expr::StmtList *list = new expr::StmtList;
-    list->add_statement(new expr::EdgeStmt{"1", "2"});
-    stack.push_back(list);
-    stack.push_back(new expr::EdgeStmt{"1", "3"});
-
-    EXPECT_TRUE(to_list.perform(Token{TokenType::NUMERAL, "4"}, stack));
-    EXPECT_EQ(stack.size(), 1);
-    EXPECT_TRUE(expr::StmtList::is_instance(stack.back()));
-
-    // Add another statement
-    reduce::ToStatement to_stmt;
-
-    add_tokens(stack, "4 -- 3;");
-
-    EXPECT_TRUE(to_stmt.perform(t('}'), stack));
-    EXPECT_EQ(stack.size(), 2);
-    EXPECT_TRUE(expr::Statement::is_instance(stack.back()));
-
-    // Fold it into the list
-
-    EXPECT_TRUE(to_list.perform(t('}'), stack));
-    EXPECT_EQ(stack.size(), 1);
-    EXPECT_TRUE(expr::StmtList::is_instance(stack.back()));
-
-    cleanup(stack);
+TEST(ParseFail, nodeStatement) {
+    ASSERT_ANY_THROW(parse("graph { a = b; }"));
 }
 
-TEST(ReductionFail, stmtList) {
-    reduce::ToStmtList to_list;
-    ParseStack stack;
-    add_tokens(stack, "foo -- bar;");
-
-    auto pre_size = stack.size();
-    EXPECT_FALSE(to_list.perform(t('\0'), stack));
-    EXPECT_EQ(stack.size(), pre_size);
-
-    cleanup(stack);
+TEST(ParseSuccess, emptyGraph) {
+    auto p = Parser::of(std::string_view{"graph foo {}"});
+    EXPECT_TRUE(expr::FullGraph::is_instance(p.parse()));
+    EXPECT_EQ(load("graph foo {}").node_count(), 0);
 }
 
-TEST(ReductionSuccess, graph) {
-    reduce::ToGraph to_graph;
-    ParseStack stack;
-    add_tokens(stack, "graph foo {");
-    stack.push_back(new expr::StmtList);
-    add_tokens(stack, "}");
-
-    EXPECT_TRUE(to_graph.perform(t('\0'), stack));
-    EXPECT_EQ(stack.size(), 1);
-    EXPECT_TRUE(expr::FullGraph::is_instance(stack.back()));
-
-    cleanup(stack);
+TEST(ParseFail, trailingInput) {
+    ASSERT_ANY_THROW(parse("graph foo { a; } b"));
 }
 
-TEST(ReductionFail, graphNoEOI) {
-    reduce::ToGraph to_graph;
-    ParseStack stack;
-    add_tokens(stack, "graph foo {");
-    stack.push_back(new expr::StmtList);
-    add_tokens(stack, "}");
-
-    auto pre_size = stack.size();
-    EXPECT_FALSE(to_graph.perform(t(';'), stack));
-    EXPECT_EQ(stack.size(), pre_size);
-
-    cleanup(stack);
+TEST(ParseFail, noGraph) {
+    ASSERT_ANY_THROW(parse("foo -- bar;"));
 }
 
-TEST(ReductionFail, graphNoGraph) {
-    reduce::ToGraph to_graph;
-    ParseStack stack;
-    add_tokens(stack, "graph foo {\nx -- y;");
-
-    auto pre_size = stack.size();
-    EXPECT_FALSE(to_graph.perform(t('\0'), stack));
-    EXPECT_EQ(stack.size(), pre_size);
-
-    cleanup(stack);
+TEST(ParseFail, syntaxErrorNamesToken) {
+    try {
+        parse("graph { a -- b -- c; }");
+        FAIL();
+    } catch (const std::runtime_error &e) {
+        EXPECT_NE(std::string{e.what()}.find("--"), std::string::npos);
+    }
 }
 
 TEST(ParseSuccess, fullGraph) {
@@ -281,8 +102,39 @@ TEST(ParseSuccess, fullGraph) {
     Expression *ex = p.parse();
 
     ASSERT_NE(ex, nullptr);
+}
+
+TEST(ParseSuccess, nodeStatements) {
+    std::istringstream in{"graph {\n"
+                          "    a [pos=\"0,0\"];\n"
+                          "    b [color=red, pos=\"3.5,-1!\"];\n"
+                          "    c;\n"
+                          "    a -- b [weight=5];\n"
+                          "}"};
+    auto p = Parser::of(in);
+    Expression *ex = p.parse();
+
+    graphd::Graph g;
+    ex->apply_to_graph(g);
+    g.freeze();
 
-    delete ex;
+    EXPECT_EQ(g.node_count(), 3);
+    EXPECT_EQ(g.edge_count(), 1);
+
+    auto pos = g.position(g.id_of("b"));
+    ASSERT_TRUE(pos.has_value());
+    EXPECT_EQ(pos->x, 3.5);
+    EXPECT_EQ(pos->y, -1.0);
+    EXPECT_FALSE(g.position(g.id_of("c")).has_value());
+}
+
+TEST(ParseFail, invalidPosition) {
+    std::istringstream in{"graph { a [pos=\"1;2\"]; }"};
+    auto p = Parser::of(in);
+    Expression *ex = p.parse();
+
+    graphd::Graph g;
+    ASSERT_ANY_THROW(ex->apply_to_graph(g));
 }
 
 TEST(ParseFail, incomplete) {
@@ -301,17 +153,15 @@ TEST(ParseFail, illegalToken) {
                               "    2 -> 3;\n"
                               "}\n\t"};
 
-        Expression *ex = nullptr;
         try {
             auto p = Parser::of(in);
-            ex = p.parse();
+            p.parse();
             ASSERT_TRUE(false);
         } catch (const std::exception &e) {
             std::string msg = e.what();
             // Message contains the first illegal token?
             ASSERT_NE(msg.find("digraph"), std::string::npos);
         }
-        delete ex;
     }
 
     {
@@ -322,15 +172,119 @@ TEST(ParseFail, illegalToken) {
                               "}\n\t"};
         auto p = Parser::of(in);
 
-        Expression *ex = nullptr;
         try {
-            ex = p.parse();
+            p.parse();
             ASSERT_TRUE(false);
         } catch (const std::exception &e) {
             std::string msg = e.what();
             // Message contains the first illegal token?
             ASSERT_NE(msg.find("->"), std::string::npos);
         }
-        delete ex;
     }
 }
+
+TEST(ParseSuccess, parseInto) {
+    std::string input{"strict graph streamed {\n"
+                      "    a [pos=\"1,2\"];\n"
+                      "    a -- b [weight=3];\n"
+                      "    b -- c;\n"
+                      "    a -- b [weight=2];\n"
+                      "}"};
+
+    graphd::Graph expected;
+    {
+        auto p = Parser::of(std::string_view{input});
+        p.parse()->apply_to_graph(expected);
+        expected.freeze();
+    }
+
+    graphd::Graph g;
+    auto p = Parser::of(std::string_view{input});
+    p.parse_into(g);
+    g.freeze();
+
+    EXPECT_EQ(g.node_count(), expected.node_count());
+    EXPECT_EQ(g.edge_count(), expected.edge_count());
+    EXPECT_EQ(g.shortest_path("a", "c").total_distance,
+              expected.shortest_path("a", "c").total_distance);
+    EXPECT_TRUE(g.position(g.id_of("a")).has_value());
+}
+
+TEST(ParseFail, parseIntoIncomplete) {
+    std::istringstream in{"graph { a -- b; c -- "};
+    auto p = Parser::of(in);
+
+    graphd::Graph g;
+    ASSERT_ANY_THROW(p.parse_into(g));
+}
+
+static void expect_same(const graphd::Graph &g, const graphd::Graph &expected) {
+    EXPECT_EQ(g.name(), expected.name());
+    ASSERT_EQ(g.node_count(), expected.node_count());
+    EXPECT_EQ(g.edge_count(), expected.edge_count());
+    for (graphd::NodeId n = 0; n < g.node_count(); n++) {
+        EXPECT_EQ(g.name_of(n), expected.name_of(n));
+        auto pos = g.position(n);
+        auto expected_pos = expected.position(n);
+        ASSERT_EQ(pos.has_value(), expected_pos.has_value());
+        if (pos.has_value()) {
+            EXPECT_EQ(pos->x, expected_pos->x);
+            EXPECT_EQ(pos->y, expected_pos->y);
+        }
+        // Neighbors are sorted, so equal adjacencies list them alike.
+        ASSERT_EQ(g.edges_end(n) - g.edges_begin(n),
+                  expected.edges_end(n) - expected.edges_begin(n));
+        for (auto e = g.edges_begin(n), f = expected.edges_begin(n);
+             e < g.edges_end(n); e++, f++) {
+            EXPECT_EQ(g.edge_target(e), expected.edge_target(f));
+            EXPECT_EQ(g.edge_weight(e), expected.edge_weight(f));
+        }
+    }
+}
+
+TEST(ParseSuccess, parallel) {
+    std::string input = document(500);
+    graphd::Graph expected = load(input);
+    EXPECT_EQ(expected.name(), "par;allel");
+
+    for (unsigned threads : {2, 3, 8}) {
+        graphd::Graph g;
+        parse_parallel(input, g, threads, 64);
+        g.freeze();
+        expect_same(g, expected);
+    }
+}
+
+TEST(ParseSuccess, parallelTooSmall) {
+    graphd::Graph g;
+    parse_parallel("graph { a -- b; }", g, 4, 64);
+    g.freeze();
+    EXPECT_EQ(g.edge_count(), 1);
+}
+
+TEST(ParseFail, parallelSameError) {
+    std::string input = document(500);
+    input.insert(input.size() / 2, " -- ;");
+
+    std::string expected;
+    try {
+        load(input);
+        FAIL();
+    } catch (const std::runtime_error &e) {
+        expected = e.what();
+    }
+
+    graphd::Graph g;
+    try {
+        parse_parallel(input, g, 4, 64);
+        FAIL();
+    } catch (const std::runtime_error &e) {
+        EXPECT_EQ(std::string{e.what()}, expected);
+    }
+}
+
+TEST(ParseFail, parallelTrailingInput) {
+    std::string input = document(500) + "b";
+    graphd::Graph g;
+    ASSERT_ANY_THROW(parse_parallel(input, g, 4, 64));
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <graphd/query.hpp>
+
+#include <sstream>
+
+using namespace graphd;
+
+TEST(Query, parse) {
+    auto q = parse_query("  from\tto ");
+
+    ASSERT_TRUE(q.has_value());
+    EXPECT_EQ(q->from, "from");
+    EXPECT_EQ(q->to, "to");
+}
+
+TEST(Query, parse_blank) {
+    EXPECT_FALSE(parse_query("").has_value());
+    EXPECT_FALSE(parse_query(" \t ").has_value());
+}
+
+TEST(Query, parse_malformed) {
+    EXPECT_ANY_THROW(parse_query("from"));
+    EXPECT_ANY_THROW(parse_query("from to somewhere"));
+}
+
+TEST(Query, read_nodes) {
+    std::istringstream in{" a\n\nb \t\n"};
+    EXPECT_EQ(read_nodes(in), (std::vector<NodeName>{"a", "b"}));
+
+    std::istringstream malformed{"a b\n"};
+    EXPECT_ANY_THROW(read_nodes(malformed));
+}
+
+TEST(Query, batch_in_order) {
+    Graph g;
+    g.add_edge("a", "b", 1.0);
+    g.add_edge("b", "c", 2.5);
+    g.freeze();
+
+    std::istringstream in{"a c\n"
+                          "\n"
+                          "c x\n"
+                          "b a\n"};
+    std::ostringstream out;
+
+    run_batch(g, in, out);
+
+    EXPECT_EQ(out.str(), "3.5\ta -> b -> c\n"
+                         "error: no such node: x\n"
+                         "1\tb -> a\n");
+}
+
+TEST(Query, batch_parallel_matches_sequential) {
+    Graph g;
+    for (int i = 0; i < 100; i++) {
+        g.add_edge(std::to_string(i), std::to_string((i * 7 + 3) % 100),
+                   1.0 + i % 5);
+        g.add_edge(std::to_string(i), std::to_string((i + 1) % 100), 4.0);
+    }
+    g.freeze();
+
+    std::string queries;
+    for (int i = 0; i < 1000; i++) {
+        queries += std::to_string(i % 100) + " " +
+                   std::to_string((i * 13) % 101) + "\n";
+    }
+
+    std::istringstream in1{queries};
+    std::ostringstream out1;
+    run_batch(g, in1, out1, {1});
+
+    std::istringstream in4{queries};
+    std::ostringstream out4;
+    run_batch(g, in4, out4, {4});
+
+    EXPECT_EQ(out1.str(), out4.str());
+}
+
+TEST(Query, write_tree) {
+    Graph g;
+    g.add_edge("a", "b", 1.0);
+    g.add_edge("b", "c", 2.5);
+    g.add_node("x");
+    g.freeze();
+
+    std::ostringstream out;
+    write_tree(g, g.shortest_path_tree("b"), out);
+
+    EXPECT_EQ(out.str(), "a\t1\tb\n"
+                         "b\t0\t\n"
+                         "c\t2.5\tb\n");
+}
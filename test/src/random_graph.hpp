@@ -0,0 +1,90 @@
+/*
+ * Deterministic pseudo-random graphs for tests that compare algorithms.
+ *
+ * Numbers come from a linear congruential generator rather than the standard
+ * library, so that tests see the same graphs everywhere.
+ */
+#ifndef _GRAPHD_TEST_RANDOM_GRAPH_H_
+#define _GRAPHD_TEST_RANDOM_GRAPH_H_
+
+#include <graphd/graph.hpp>
+
+#include <string>
+
+namespace graphd::test {
+
+class Random {
+  public:
+    explicit Random(unsigned seed) : seed{seed} {}
+    unsigned next() {
+        return seed = seed * 1103515245 + 12345;
+    }
+    /**
+     * One of the nodes named "0" to "nodes - 1".
+     */
+    NodeName node(int nodes) {
+        return std::to_string(next() % nodes);
+    }
+
+  private:
+    unsigned seed;
+};
+
+/**
+ * The shape of a random graph on nodes named "0" to "nodes - 1".
+ */
+struct RandomGraph {
+    int nodes;
+    // Edges between random nodes, weighing 0 to 9.9
+    int random_edges = 0;
+    // Whether to connect each node to a random node before it, by an edge
+    // weighing 1 to 10.9, which keeps the graph connected
+    bool tree = false;
+    // If positive, the weight of edges from each node to the next and from
+    // the last to the first, which keep the graph connected as well
+    double ring = 0;
+    // Whether to add an edge x -- y of weight 1, connected to nothing else
+    bool extra_component = false;
+};
+
+/**
+ * Add the edges of a graph of the given shape to g.
+ */
+inline void add_random_edges(Graph &g, const RandomGraph &shape,
+                             Random &rng) {
+    if (shape.tree) {
+        for (int i = 1; i < shape.nodes; i++) {
+            g.add_edge(rng.node(i), std::to_string(i),
+                       1.0 + (rng.next() % 100) / 10.0);
+        }
+    }
+    if (shape.ring > 0) {
+        for (int i = 0; i < shape.nodes; i++) {
+            g.add_edge(std::to_string(i), std::to_string((i + 1) % shape.nodes),
+                       shape.ring);
+        }
+    }
+    for (int i = 0; i < shape.random_edges; i++) {
+        NodeName from = rng.node(shape.nodes);
+        NodeName to = rng.node(shape.nodes);
+        g.add_edge(from, to, (rng.next() % 100) / 10.0);
+    }
+    if (shape.extra_component) {
+        g.add_edge("x", "y", 1.0);
+    }
+}
+
+/**
+ * A frozen graph of the given shape.
+ */
+inline Graph random_graph(const RandomGraph &shape, unsigned seed) {
+    Graph g;
+    Random rng{seed};
+    add_random_edges(g, shape, rng);
+    g.freeze();
+    return g;
+}
+
+} // namespace graphd::test
+
+#endif // _GRAPHD_TEST_RANDOM_GRAPH_H_
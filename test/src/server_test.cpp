@@ -0,0 +1,249 @@
+#include <gtest/gtest.h>
+
+#include <graphd/server.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace graphd;
+
+static Graph sample_graph() {
+    Graph g;
+    g.add_edge("a", "b", 1.0);
+    g.add_edge("b", "c", 2.0);
+    g.add_edge("a", "c", 4.0);
+    g.add_node("lonely");
+    g.freeze();
+    return g;
+}
+
+static sockaddr_un address(const std::string &path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    path.copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+    return addr;
+}
+
+static int connect_to(const std::string &path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr = address(path);
+    if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void send_all(int fd, const std::string &data) {
+    for (std::size_t sent = 0; sent < data.size();) {
+        ssize_t r = write(fd, data.data() + sent, data.size() - sent);
+        ASSERT_GT(r, 0);
+        sent += r;
+    }
+}
+
+static std::string receive_line(int fd) {
+    std::string line;
+    char c;
+    while (read(fd, &c, 1) == 1 && c != '\n') {
+        line += c;
+    }
+    return line;
+}
+
+/**
+ * Send all requests, then read answers until the server closes.
+ */
+static std::string ask(const std::string &path, const std::string &requests) {
+    int fd = connect_to(path);
+    EXPECT_GE(fd, 0);
+    send_all(fd, requests);
+    shutdown(fd, SHUT_WR);
+    std::string answers;
+    char buffer[4096];
+    ssize_t r;
+    while ((r = read(fd, buffer, sizeof(buffer))) > 0) {
+        answers.append(buffer, r);
+    }
+    close(fd);
+    return answers;
+}
+
+class ServerTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        path = ::testing::TempDir() + "graphd_server_test.sock";
+    }
+    void start(const BatchOptions &options = {}) {
+        server = std::make_unique<Server>(g, path, options);
+        thread = std::thread{[this] { server->run(); }};
+    }
+    void start(ServedGraph graph, std::function<ServedGraph()> load) {
+        server = std::make_unique<Server>(std::move(graph), path, load);
+        thread = std::thread{[this] { server->run(); }};
+    }
+    void TearDown() override {
+        if (server) {
+            server->stop();
+            thread.join();
+            server.reset();
+        }
+        std::remove(path.c_str());
+    }
+
+    Graph g = sample_graph();
+    std::string path;
+    std::unique_ptr<Server> server;
+    std::thread thread;
+};
+
+TEST_F(ServerTest, answers_in_order) {
+    start();
+    EXPECT_EQ(ask(path, "a c\n\nc a\na lonely\na nope\nb b"),
+              "3\ta -> b -> c\n"
+              "3\tc -> b -> a\n"
+              "error: nodes not connected: a, lonely\n"
+              "error: no such node: nope\n"
+              "0\tb\n");
+}
+
+TEST_F(ServerTest, partial_lines) {
+    start();
+    int fd = connect_to(path);
+    ASSERT_GE(fd, 0);
+    send_all(fd, "a ");
+    send_all(fd, "c\nc");
+    EXPECT_EQ(receive_line(fd), "3\ta -> b -> c");
+    send_all(fd, " b\n");
+    EXPECT_EQ(receive_line(fd), "2\tc -> b");
+    close(fd);
+}
+
+TEST_F(ServerTest, concurrent_clients) {
+    BatchOptions options;
+    options.threads = 3;
+    start(options);
+
+    std::string requests;
+    std::string expected;
+    for (int i = 0; i < 2000; i++) {
+        requests += i % 2 ? "a c\n" : "c b\n";
+        expected += i % 2 ? "3\ta -> b -> c\n" : "2\tc -> b\n";
+    }
+    std::vector<std::string> answers(8);
+    std::vector<std::thread> clients;
+    for (auto &a : answers) {
+        clients.emplace_back([&] { a = ask(path, requests); });
+    }
+    for (auto &t : clients) {
+        t.join();
+    }
+    for (const auto &a : answers) {
+        EXPECT_EQ(a, expected);
+    }
+}
+
+TEST_F(ServerTest, replaces_stale_socket) {
+    // A process killed before cleaning up leaves its socket file behind.
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr = address(path);
+    ASSERT_EQ(bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)), 0);
+    close(fd);
+
+    start();
+    EXPECT_EQ(ask(path, "a b\n"), "1\ta -> b\n");
+}
+
+TEST_F(ServerTest, fail_socket_in_use) {
+    start();
+    Graph other = sample_graph();
+    EXPECT_THROW(Server(other, path), std::runtime_error);
+    // The running server keeps its socket.
+    EXPECT_EQ(ask(path, "a b\n"), "1\ta -> b\n");
+}
+
+TEST_F(ServerTest, removes_socket) {
+    start();
+    server->stop();
+    thread.join();
+    server.reset();
+    struct stat st;
+    EXPECT_NE(lstat(path.c_str(), &st), 0);
+}
+
+/**
+ * Ask until the answer is expected, for a while.
+ */
+static bool eventually(const std::string &path, const std::string &request,
+                       const std::string &expected) {
+    for (int i = 0; i < 1000; i++) {
+        if (ask(path, request) == expected) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+    return false;
+}
+
+TEST_F(ServerTest, reload) {
+    auto first = std::make_shared<Graph>(sample_graph());
+    std::weak_ptr<Graph> old = first;
+    std::atomic<int> loads = 0;
+    start(ServedGraph{first.get(), {}, std::move(first)}, [&loads] {
+        if (++loads == 2) {
+            throw std::runtime_error{"cannot load"};
+        }
+        auto next = std::make_shared<Graph>();
+        next->add_edge("a", "b", 5.0);
+        next->freeze();
+        return ServedGraph{next.get(), {}, next};
+    });
+    EXPECT_EQ(ask(path, "a b\n"), "1\ta -> b\n");
+
+    server->reload();
+    EXPECT_TRUE(eventually(path, "a b\n", "5\ta -> b\n"));
+    // Freed once no batch uses it anymore
+    for (int i = 0; i < 1000 && !old.expired(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+    EXPECT_TRUE(old.expired());
+
+    // A failed load keeps the current graph.
+    server->reload();
+    for (int i = 0; i < 1000 && loads < 2; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+    ASSERT_EQ(loads, 2);
+    // Whatever the failed load would have published shows up by then.
+    for (int i = 0; i < 20; i++) {
+        EXPECT_EQ(ask(path, "a b\n"), "5\ta -> b\n");
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+    EXPECT_EQ(loads, 2);
+}
+
+TEST_F(ServerTest, reload_without_loader) {
+    start();
+    server->reload();
+    EXPECT_EQ(ask(path, "a b\n"), "1\ta -> b\n");
+}
+
+TEST(Server, fail_path_taken) {
+    std::string path = ::testing::TempDir() + "graphd_server_test.txt";
+    std::FILE *f = std::fopen(path.c_str(), "w");
+    std::fclose(f);
+    Graph g = sample_graph();
+    EXPECT_THROW(Server(g, path), std::runtime_error);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <graphd/ch.hpp>
+#include <graphd/snapshot.hpp>
+#include <graphd/workspace.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using namespace graphd;
+
+class SnapshotTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        path = ::testing::TempDir() + "graphd_snapshot_test.graphd";
+    }
+    void TearDown() override {
+        std::remove(path.c_str());
+    }
+    void write(const Graph &g, const ContractionHierarchy *ch = nullptr) {
+        std::ofstream out{path, std::ios::binary};
+        Snapshot::write(out, g, ch);
+    }
+
+    std::string path;
+};
+
+static Graph sample_graph() {
+    Graph g;
+    g.add_edge("a", "b", 2.0);
+    g.add_edge("b", "c", 1.5);
+    g.add_edge("a", "c", 4.0);
+    g.add_edge("c", "d");
+    g.add_node("lonely");
+    g.set_position("a", Position{1.0, 2.0});
+    g.freeze();
+    return g;
+}
+
+TEST_F(SnapshotTest, round_trip) {
+    Graph g = sample_graph();
+    write(g);
+    ASSERT_TRUE(Snapshot::is_snapshot(path));
+
+    Snapshot s = Snapshot::load(path);
+    const Graph &loaded = s.graph();
+    EXPECT_TRUE(loaded.is_frozen());
+    EXPECT_EQ(loaded.node_count(), g.node_count());
+    EXPECT_EQ(loaded.edge_count(), g.edge_count());
+    for (NodeId n = 0; n < g.node_count(); n++) {
+        EXPECT_EQ(loaded.name_of(n), g.name_of(n));
+        EXPECT_EQ(loaded.id_of(NodeName{g.name_of(n)}), n);
+    }
+    EXPECT_EQ(loaded.position(loaded.id_of("a"))->y, 2.0);
+    EXPECT_FALSE(loaded.position(loaded.id_of("b")).has_value());
+    EXPECT_THROW(loaded.id_of("nope"), std::runtime_error);
+    EXPECT_EQ(s.hierarchy(), nullptr);
+    EXPECT_EQ(s.landmarks(), nullptr);
+
+    Path p = loaded.shortest_path("a", "d");
+    EXPECT_EQ(p.total_distance, 4.5);
+    EXPECT_EQ(p.nodes, (std::vector<NodeName>{"a", "b", "c", "d"}));
+}
+
+TEST_F(SnapshotTest, round_trip_hierarchy) {
+    Graph g;
+    for (int i = 0; i < 50; i++) {
+        g.add_edge(std::to_string(i), std::to_string((i * 7 + 3) % 50),
+                   1.0 + i % 5);
+        g.add_edge(std::to_string(i), std::to_string((i + 1) % 50), 3.0);
+    }
+    g.freeze();
+    ContractionHierarchy ch{g};
+    write(g, &ch);
+
+    Snapshot s = Snapshot::load(path);
+    ASSERT_NE(s.hierarchy(), nullptr);
+    EXPECT_EQ(s.hierarchy()->shortcut_count(), ch.shortcut_count());
+    SearchWorkspace ws;
+    for (int i = 0; i < 50; i += 7) {
+        for (int j = 0; j < 50; j += 3) {
+            auto from = std::to_string(i);
+            auto to = std::to_string(j);
+            Path expected = g.shortest_path(from, to);
+            Path actual = s.hierarchy()->shortest_path(from, to, ws);
+            EXPECT_EQ(actual.total_distance, expected.total_distance);
+            EXPECT_EQ(actual.nodes.front(), from);
+            EXPECT_EQ(actual.nodes.back(), to);
+        }
+    }
+}
+
+TEST_F(SnapshotTest, round_trip_landmarks) {
+    Graph g = sample_graph();
+    LandmarkHeuristic alt{g, 2};
+    {
+        std::ofstream out{path, std::ios::binary};
+        Snapshot::write(out, g, nullptr, &alt);
+    }
+
+    Snapshot s = Snapshot::load(path);
+    EXPECT_EQ(s.hierarchy(), nullptr);
+    ASSERT_NE(s.landmarks(), nullptr);
+    EXPECT_EQ(&s.landmarks()->graph(), &s.graph());
+    ASSERT_EQ(s.landmarks()->landmarks().size(), 2);
+    for (NodeId from = 0; from < g.node_count(); from++) {
+        for (NodeId to = 0; to < g.node_count(); to++) {
+            EXPECT_EQ(s.landmarks()->estimate(from, to),
+                      alt.estimate(from, to));
+        }
+    }
+}
+
+TEST_F(SnapshotTest, fail_landmarks_of_other_graph) {
+    Graph g = sample_graph();
+    Graph other = sample_graph();
+    LandmarkHeuristic alt{other, 2};
+    std::ofstream out{path, std::ios::binary};
+    EXPECT_THROW(Snapshot::write(out, g, nullptr, &alt), std::logic_error);
+}
+
+TEST_F(SnapshotTest, fail_out_of_date) {
+    Graph g = sample_graph();
+    ContractionHierarchy ch{g};
+    LandmarkHeuristic alt{g, 2};
+    g.set_edge_weight("a", "b", 0.5);
+    std::ofstream out{path, std::ios::binary};
+    EXPECT_THROW(Snapshot::write(out, g, &ch, nullptr), std::logic_error);
+    EXPECT_THROW(Snapshot::write(out, g, nullptr, &alt), std::logic_error);
+}
+
+TEST_F(SnapshotTest, update_copy) {
+    write(sample_graph());
+    Snapshot s = Snapshot::load(path);
+
+    // The mapped weights are copied rather than written to.
+    Graph g = s.graph();
+    EXPECT_EQ(g.set_edge_weight("a", "b", 0.5), 2.0);
+    EXPECT_EQ(g.shortest_path("a", "c").total_distance, 2.0);
+    EXPECT_EQ(s.graph().shortest_path("a", "c").total_distance, 3.5);
+    Snapshot again = Snapshot::load(path);
+    EXPECT_EQ(again.graph().shortest_path("a", "b").total_distance, 2.0);
+}
+
+TEST_F(SnapshotTest, empty_graph) {
+    Graph g;
+    g.freeze();
+    write(g);
+    Snapshot s = Snapshot::load(path);
+    EXPECT_EQ(s.graph().node_count(), 0);
+    EXPECT_THROW(s.graph().id_of("a"), std::runtime_error);
+}
+
+TEST_F(SnapshotTest, fail_not_frozen) {
+    Graph g;
+    g.add_edge("a", "b");
+    std::ofstream out{path, std::ios::binary};
+    EXPECT_THROW(Snapshot::write(out, g), std::logic_error);
+}
+
+TEST_F(SnapshotTest, fail_not_a_snapshot) {
+    {
+        std::ofstream out{path};
+        out << "graph { a -- b; }\n";
+    }
+    EXPECT_FALSE(Snapshot::is_snapshot(path));
+    EXPECT_THROW(Snapshot::load(path), std::runtime_error);
+}
+
+TEST_F(SnapshotTest, fail_truncated) {
+    write(sample_graph());
+    std::string contents;
+    {
+        std::ifstream in{path, std::ios::binary};
+        contents.assign(std::istreambuf_iterator<char>{in}, {});
+    }
+    {
+        std::ofstream out{path, std::ios::binary};
+        out.write(contents.data(), contents.size() / 2);
+    }
+    EXPECT_TRUE(Snapshot::is_snapshot(path));
+    EXPECT_THROW(Snapshot::load(path), std::runtime_error);
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <graphd/input/load.hpp>
+#include <graphd/input/parse.hpp>
+#include <graphd/query.hpp>
+#include <graphd/stats.hpp>
+#include <graphd/workspace.hpp>
+
+#include "document.hpp"
+
+#include <sstream>
+#include <string>
+#include <string_view>
+
+using namespace graphd;
+
+TEST(Stats, parse) {
+    graphd::Graph g;
+    auto p = input::Parser::of(std::string_view{"graph { a -- b [w=1]; }"});
+    p.parse_into(g);
+    if (counters_enabled) {
+        // graph { a -- b [ w = 1 ] ; } and the end of input
+        EXPECT_EQ(p.counters().tokens, 13);
+        EXPECT_GT(p.counters().max_stack_depth, 0);
+    } else {
+        EXPECT_EQ(p.counters().tokens, 0);
+        EXPECT_EQ(p.counters().max_stack_depth, 0);
+    }
+}
+
+TEST(Stats, parseParallel) {
+    std::string input = test::document(200);
+    graphd::Graph serial;
+    auto p = input::Parser::of(std::string_view{input});
+    p.parse_into(serial);
+
+    graphd::Graph g;
+    ParseCounters counters = input::parse_parallel(input, g, 4, 64);
+    // Chunks share the statements, not the header and closing brace.
+    EXPECT_LE(counters.tokens, p.counters().tokens + 4 * 4);
+    EXPECT_GE(counters.tokens + 8, p.counters().tokens);
+    EXPECT_EQ(counters.tokens > 0, counters_enabled);
+}
+
+TEST(Stats, search) {
+    graphd::Graph g;
+    auto p = input::Parser::of(std::string_view{
+        "graph { a -- b [weight=1]; b -- c [weight=2]; a -- c [weight=4]; }"});
+    p.parse_into(g);
+    g.freeze();
+
+    SearchCounters counters;
+    BatchOptions options;
+    options.counters = &counters;
+    std::istringstream in{"a c\n"};
+    std::ostringstream out;
+    run_batch(g, in, out, options);
+    EXPECT_EQ(out.str(), "3\ta -> b -> c\n");
+
+    if (counters_enabled) {
+        // a, b and c settled, with one stale entry for c
+        EXPECT_EQ(counters.settled, 3);
+        EXPECT_EQ(counters.pushes, 4);
+        EXPECT_GE(counters.pops, counters.settled);
+        EXPECT_GE(counters.relaxed, counters.pushes);
+    } else {
+        EXPECT_EQ(counters.settled, 0);
+        EXPECT_EQ(counters.relaxed, 0);
+        EXPECT_EQ(counters.pushes, 0);
+        EXPECT_EQ(counters.pops, 0);
+    }
+}
+
+TEST(Stats, json) {
+    RunStats stats;
+    stats.start_phase("parse");
+    stats.start_phase("query");
+    stats.end_phase();
+    stats.nodes = 3;
+    stats.edges = 2;
+    std::ostringstream out;
+    stats.write_json(out);
+    std::string json = out.str();
+
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_LT(json.find("\"parse\": "), json.find("\"query\": "));
+    EXPECT_NE(json.find("\"graph\": {\"nodes\": 3, \"edges\": 2}"),
+              std::string::npos);
+    EXPECT_EQ(json.find("\"search\"") != std::string::npos, counters_enabled);
+    EXPECT_NE(json.find(counters_enabled ? "\"counters\": true"
+                                         : "\"counters\": false"),
+              std::string::npos);
+}
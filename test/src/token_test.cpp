@@ -107,3 +107,34 @@ TEST(TokenizerMultipleTokens, simpleGraph) {
         EXPECT_EQ(token.value, ex.value);
     }
 }
+
+TEST(TokenizerBuffer, values_refer_to_input) {
+    std::string_view input{"foo_1 \"bar\" -1.5"};
+    Tokenizer tok{input};
+
+    for (auto expected : {"foo_1", "bar", "-1.5"}) {
+        Token token = tok.next_token();
+        EXPECT_EQ(token.value, expected);
+        EXPECT_GE(token.value.data(), input.data());
+        EXPECT_LE(token.value.data() + token.value.size(),
+                  input.data() + input.size());
+    }
+    EXPECT_EQ(tok.next_token().type, TokenType::EOI);
+}
+
+TEST(TokenizerBuffer, escaped_string) {
+    std::string_view input{"\"say \\\"hi\\\"\" x"};
+    Tokenizer tok{input};
+
+    Token token = tok.next_token();
+    EXPECT_EQ(token.type, TokenType::NAME);
+    EXPECT_EQ(token.value, "say \"hi\"");
+    EXPECT_EQ(tok.next_token().value, "x");
+}
+
+TEST(TokenizerSingleTokenFail, lone_minus) {
+    std::string_view input{"-x"};
+    Tokenizer tok{input};
+
+    ASSERT_ANY_THROW(tok.next_token());
+}